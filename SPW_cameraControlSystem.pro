@@ -18,7 +18,16 @@ SOURCES += \
     hudwindow.cpp \
     settingscontroller.cpp \
     languagemanager.cpp \
-    themedmessagedialog.cpp
+    themedmessagedialog.cpp \
+    framepool.cpp \
+    gopringbuffer.cpp \
+    latencyhistogram.cpp \
+    latencycontroller.cpp \
+    streamsessionmanager.cpp \
+    ingestpipeline.cpp \
+    videosurfaceitem.cpp \
+    overlaystripcache.cpp \
+    framescaler.cpp
 
 HEADERS += \
     mainwindow.h \
@@ -27,12 +36,20 @@ HEADERS += \
     videorecorder.h \
     restipclient.h \
     myStruct.h \
-    ZoomPanImageView.h \
     uicontroller.h \
     hudwindow.h \
     settingscontroller.h \
     languagemanager.h \
-    themedmessagedialog.h
+    themedmessagedialog.h \
+    framepool.h \
+    gopringbuffer.h \
+    latencyhistogram.h \
+    latencycontroller.h \
+    streamsessionmanager.h \
+    ingestpipeline.h \
+    videosurfaceitem.h \
+    overlaystripcache.h \
+    framescaler.h
 
 FORMS += mainwindow.ui
 
@@ -0,0 +1,76 @@
+#include "framepool.h"
+
+#include <QMutexLocker>
+#include <algorithm>
+
+FramePool::FramePool(int initialSlots, int maxSlots)
+    : st_(std::make_shared<State>())
+{
+    st_->maxSlots = std::max(1, maxSlots);
+    st_->initialSlots = std::clamp(initialSlots, 1, st_->maxSlots);
+}
+
+void FramePool::setMaxSlots(int n)
+{
+    QMutexLocker lk(&st_->mtx);
+    st_->maxSlots = std::max(1, n);
+    st_->initialSlots = std::min(st_->initialSlots, st_->maxSlots);
+}
+
+int FramePool::maxSlots() const
+{
+    QMutexLocker lk(&st_->mtx);
+    return st_->maxSlots;
+}
+
+int FramePool::slotCount() const
+{
+    QMutexLocker lk(&st_->mtx);
+    return (int)st_->slots.size();
+}
+
+QSharedPointer<QImage> FramePool::acquire(int w, int h, QImage::Format fmt)
+{
+    if (w <= 0 || h <= 0) return {};
+
+    QMutexLocker lk(&st_->mtx);
+    State& st = *st_;
+
+    auto newSlot = [&]() -> std::shared_ptr<Slot> {
+        auto s = std::make_shared<Slot>();
+        s->img = QImage(w, h, fmt);
+        if (s->img.isNull()) return {};
+        st.allocations.fetch_add(1, std::memory_order_relaxed);
+        st.slots.push_back(s);
+        return s;
+    };
+
+    if (st.size != QSize(w, h) || st.fmt != fmt) {
+        // 旧槽交给仍在用的持有者（deleter 持有 shared_ptr），空闲的随 clear 释放
+        st.slots.clear();
+        st.size = QSize(w, h);
+        st.fmt  = fmt;
+        for (int i = 0; i < st.initialSlots; ++i)
+            if (!newSlot()) break;
+    }
+
+    std::shared_ptr<Slot> pick;
+    for (const auto& s : st.slots) {
+        // inUse：QSharedPointer 仍有引用；isDetached：没有 QImage 隐式共享副本
+        if (!s->inUse.load(std::memory_order_acquire) && s->img.isDetached()) {
+            pick = s;
+            break;
+        }
+    }
+    if (!pick && (int)st.slots.size() < st.maxSlots)
+        pick = newSlot();
+    if (!pick) {
+        st.exhausted.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+
+    pick->inUse.store(true, std::memory_order_release);
+    return QSharedPointer<QImage>(&pick->img, [pick](QImage*) {
+        pick->inUse.store(false, std::memory_order_release);
+    });
+}
@@ -0,0 +1,48 @@
+// framepool.h
+// 引用计数回收帧池：槽位只有在所有消费者引用（QSharedPointer 及 QImage 隐式共享副本）
+// 全部释放后才会再次分配给生产者，避免录像/截图仍在读时被下一帧覆盖写（撕裂）。
+// 压力下在 maxSlots 上限内扩容；仍无空闲槽时 acquire() 返回空并计数（调用方丢帧）。
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QSize>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class FramePool
+{
+public:
+    explicit FramePool(int initialSlots = 5, int maxSlots = 12);
+
+    // 上限（>= 1）；已分配的槽不会因调小而回收，直到下次尺寸变化
+    void setMaxSlots(int n);
+    int  maxSlots() const;
+
+    // 取一个空闲槽；尺寸/格式变化时重建池（在用的旧槽由持有者释放后自行销毁）
+    QSharedPointer<QImage> acquire(int w, int h, QImage::Format fmt = QImage::Format_ARGB32);
+
+    int     slotCount() const;
+    quint64 exhaustedCount() const { return st_->exhausted.load(std::memory_order_relaxed); }
+    quint64 allocationCount() const { return st_->allocations.load(std::memory_order_relaxed); }
+
+private:
+    struct Slot {
+        QImage img;
+        std::atomic<bool> inUse{false};
+    };
+    struct State {
+        mutable QMutex mtx;
+        std::vector<std::shared_ptr<Slot>> slots;
+        QSize size;
+        QImage::Format fmt = QImage::Format_Invalid;
+        int initialSlots = 5;
+        int maxSlots = 12;
+        std::atomic<quint64> exhausted{0};
+        std::atomic<quint64> allocations{0};
+    };
+
+    std::shared_ptr<State> st_;
+};
@@ -0,0 +1,108 @@
+#include "framescaler.h"
+
+#include <QMutexLocker>
+#include <QtGlobal>
+#include <cmath>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SPW_FRAMESCALER_SSE2 1
+#endif
+
+FrameScaler::FrameScaler(QObject* parent)
+    : QObject(parent)
+{
+}
+
+void FrameScaler::submit(const QImage& src, const QRectF& srcRect, const QSize& dstSize, quint64 tag)
+{
+    {
+        QMutexLocker lk(&mtx_);
+        pending_ = Job{src, srcRect, dstSize, tag};   // 覆盖未开始的旧任务，旧帧随之释放
+        if (scheduled_) return;
+        scheduled_ = true;
+    }
+    QMetaObject::invokeMethod(this, [this]{ process(); }, Qt::QueuedConnection);
+}
+
+void FrameScaler::process()
+{
+    Job job;
+    {
+        QMutexLocker lk(&mtx_);
+        job = std::move(pending_);
+        pending_ = Job();
+        scheduled_ = false;
+    }
+    if (job.src.isNull() || job.dstSize.isEmpty()) return;
+
+    // 显示端还没放掉之前的结果时池满，丢掉这一帧（下一帧会再来）
+    QSharedPointer<QImage> out = pool_.acquire(job.dstSize.width(), job.dstSize.height(), job.src.format());
+    if (!out) return;
+    if (!scaleBilinear(job.src, job.srcRect, *out)) return;
+    job.src = QImage();                               // 尽早归还解码帧池的槽
+    emit scaled(*out, job.tag);
+}
+
+// 采样点 pos（源像素坐标，像素中心在 i+0.5）→ 左/上邻像素 i0 与 7 位权重（0..128）。
+// i0 <= n-2，右/下邻像素总在图内；7 位权重保证 16 位乘法 255*128 不溢出
+static inline void bilinearTap(double pos, int n, int& i0, int& w)
+{
+    pos = qBound(0.0, pos, double(n - 1));
+    i0 = qMin(int(pos), n - 2);
+    w  = int(std::lround((pos - i0) * 128.0));
+}
+
+bool FrameScaler::scaleBilinear(const QImage& src, const QRectF& srcRect, QImage& dst)
+{
+    if (src.isNull() || dst.isNull() || src.depth() != 32 || dst.depth() != 32) return false;
+    if (srcRect.width() <= 0 || srcRect.height() <= 0) return false;
+    const int sw = src.width(), sh = src.height();
+    const int dw = dst.width(),  dh = dst.height();
+    if (sw < 2 || sh < 2) return false;
+
+    // 每列的源索引与权重只算一次（工作线程独占，容量只增不减）
+    static thread_local std::vector<int> xIdx, xW;
+    if ((int)xIdx.size() < dw) { xIdx.resize(dw); xW.resize(dw); }
+    const double fx = srcRect.width() / dw, fy = srcRect.height() / dh;
+    for (int x = 0; x < dw; ++x)
+        bilinearTap(srcRect.left() + (x + 0.5) * fx - 0.5, sw, xIdx[x], xW[x]);
+
+    for (int y = 0; y < dh; ++y) {
+        int y0, wy;
+        bilinearTap(srcRect.top() + (y + 0.5) * fy - 0.5, sh, y0, wy);
+        const uchar* r0 = src.constScanLine(y0);
+        const uchar* r1 = src.constScanLine(y0 + 1);
+        quint32* out = reinterpret_cast<quint32*>(dst.scanLine(y));
+
+#ifdef SPW_FRAMESCALER_SSE2
+        // 一次取相邻两像素（8 字节）展开成 8 个 16 位通道：先纵向插值，再把高 64 位（右像素）向左插
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i vwy  = _mm_set1_epi16(short(wy));
+        for (int x = 0; x < dw; ++x) {
+            const int off = xIdx[x] * 4;
+            const __m128i a = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(r0 + off)), zero);
+            const __m128i b = _mm_unpacklo_epi8(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(r1 + off)), zero);
+            const __m128i v = _mm_add_epi16(a, _mm_srai_epi16(_mm_mullo_epi16(_mm_sub_epi16(b, a), vwy), 7));
+            const __m128i r = _mm_srli_si128(v, 8);
+            const __m128i p = _mm_add_epi16(v, _mm_srai_epi16(
+                                  _mm_mullo_epi16(_mm_sub_epi16(r, v), _mm_set1_epi16(short(xW[x]))), 7));
+            out[x] = quint32(_mm_cvtsi128_si32(_mm_packus_epi16(p, p)));
+        }
+#else
+        uchar* o = reinterpret_cast<uchar*>(out);
+        for (int x = 0; x < dw; ++x) {
+            const uchar* a = r0 + xIdx[x] * 4;
+            const uchar* b = r1 + xIdx[x] * 4;
+            const int wx = xW[x];
+            for (int c = 0; c < 4; ++c) {
+                const int l = a[c]     + (((b[c]     - a[c])     * wy) >> 7);
+                const int r = a[c + 4] + (((b[c + 4] - a[c + 4]) * wy) >> 7);
+                o[x * 4 + c] = uchar(l + (((r - l) * wx) >> 7));
+            }
+        }
+#endif
+    }
+    return true;
+}
@@ -0,0 +1,44 @@
+// framescaler.h
+// 视频面的离屏预缩放：工作线程把帧的可见区域双线性重采样到目标设备像素尺寸（SSE2，
+// 无 SSE2 时标量实现，结果逐位一致），场景图只需 1:1 贴图。software 场景图后端下
+// 这一步原本由 QPainter 平滑缩放在 GUI 线程完成。
+// 只保留最新一个待处理任务（新帧覆盖未开始的旧任务）；输出缓冲来自 FramePool，稳态不分配。
+#pragma once
+
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QRectF>
+#include <QSize>
+#include "framepool.h"
+
+class FrameScaler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FrameScaler(QObject* parent = nullptr);
+
+    // 任意线程调用。srcRect：源图像素坐标（可为小数）；tag 随结果原样返回，调用方据此丢弃过期结果
+    void submit(const QImage& src, const QRectF& srcRect, const QSize& dstSize, quint64 tag);
+
+    // 32 位像素格式：src 的 srcRect 区域重采样到整个 dst（dst 须已分配）。格式不支持时返回 false
+    static bool scaleBilinear(const QImage& src, const QRectF& srcRect, QImage& dst);
+
+signals:
+    void scaled(const QImage& img, quint64 tag);
+
+private:
+    struct Job {
+        QImage  src;
+        QRectF  srcRect;
+        QSize   dstSize;
+        quint64 tag = 0;
+    };
+
+    void process();
+
+    QMutex mtx_;
+    Job    pending_;
+    bool   scheduled_ = false;
+    FramePool pool_{3, 4};          // 显示端持有 1 帧、上传中 1 帧、工作线程写 1 帧
+};
@@ -0,0 +1,72 @@
+#include "gopringbuffer.h"
+
+#include <algorithm>
+
+GopRingBuffer::GopRingBuffer(qint64 maxDurationUs, qint64 maxBytes)
+    : maxDurationUs_(std::max<qint64>(0, maxDurationUs))
+    , maxBytes_(std::max<qint64>(0, maxBytes))
+{
+}
+
+void GopRingBuffer::setLimits(qint64 maxDurationUs, qint64 maxBytes)
+{
+    maxDurationUs_ = std::max<qint64>(0, maxDurationUs);
+    maxBytes_      = std::max<qint64>(0, maxBytes);
+    if (maxDurationUs_ == 0 || maxBytes_ == 0) clear();
+    else trim();
+}
+
+void GopRingBuffer::push(const QSharedPointer<EncodedPacket>& pkt)
+{
+    if (pkt.isNull() || maxDurationUs_ == 0 || maxBytes_ == 0) return;
+
+    if (pkt->keyframe) {
+        gops_.emplace_back();
+    } else if (gops_.empty()) {
+        return;
+    }
+    gops_.back().append(pkt);
+    bytes_ += pkt->data.size();
+    trim();
+}
+
+QVector<QSharedPointer<EncodedPacket>> GopRingBuffer::snapshot() const
+{
+    QVector<QSharedPointer<EncodedPacket>> out;
+    int n = 0;
+    for (const Gop& g : gops_) n += g.size();
+    out.reserve(n);
+    for (const Gop& g : gops_) out += g;
+    return out;
+}
+
+void GopRingBuffer::clear()
+{
+    gops_.clear();
+    bytes_ = 0;
+}
+
+qint64 GopRingBuffer::durationUs() const
+{
+    if (gops_.empty()) return 0;
+    const qint64 first = gops_.front().first()->ptsUs;
+    const qint64 last  = gops_.back().last()->ptsUs;
+    if (first < 0 || last < 0) return 0;
+    return last - first;
+}
+
+void GopRingBuffer::trim()
+{
+    auto dropFront = [this]() {
+        for (const auto& p : gops_.front()) bytes_ -= p->data.size();
+        gops_.pop_front();
+    };
+
+    // 至少保留当前 GOP（预录起点必须是 IDR）
+    while (gops_.size() > 1 && (bytes_ > maxBytes_ || durationUs() > maxDurationUs_))
+        dropFront();
+
+    // 单个 GOP 已超字节上限（超长 GOP / 码流异常）：整段放弃，等下一个 IDR
+    if (gops_.size() == 1 && bytes_ > maxBytes_)
+        dropFront();
+}
@@ -0,0 +1,42 @@
+// gopringbuffer.h
+// 预录（pre-event）环形缓冲：按 GOP 保存最近 N 秒的压缩 AU，起点总是 IDR。
+// 同时受时长和字节数约束，超限时从队首整 GOP 丢弃。存的是压缩数据（~1MB/s），
+// 而不是 8MB/帧的 BGRA，内存占用稳定。非线程安全，由调用方加锁。
+#pragma once
+
+#include <QSharedPointer>
+#include <QVector>
+#include <deque>
+
+#include "myStruct.h"
+
+class GopRingBuffer
+{
+public:
+    explicit GopRingBuffer(qint64 maxDurationUs = 10LL * 1000 * 1000,
+                           qint64 maxBytes = 64LL * 1024 * 1024);
+
+    void setLimits(qint64 maxDurationUs, qint64 maxBytes);
+    qint64 maxDurationUs() const { return maxDurationUs_; }
+
+    // 首个 IDR 之前的 AU 直接丢弃（无法独立解码）
+    void push(const QSharedPointer<EncodedPacket>& pkt);
+
+    // 从最早的 IDR 开始按时间顺序返回全部 AU（浅拷贝，数据共享）
+    QVector<QSharedPointer<EncodedPacket>> snapshot() const;
+
+    void clear();
+
+    qint64 bytes() const      { return bytes_; }
+    qint64 durationUs() const;
+    int    gopCount() const   { return (int)gops_.size(); }
+
+private:
+    void trim();
+
+    using Gop = QVector<QSharedPointer<EncodedPacket>>;
+    std::deque<Gop> gops_;
+    qint64 bytes_ = 0;
+    qint64 maxDurationUs_;
+    qint64 maxBytes_;
+};
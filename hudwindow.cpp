@@ -1,9 +1,9 @@
 #include "hudwindow.h"
+#include "videosurfaceitem.h"
 #include <QQmlContext>
 #include <QQmlError>
 #include <QQuickItem>
 #include <QDebug>
-#include <QResizeEvent>
 #include <QMouseEvent>
 #include <QCursor>
 
@@ -25,19 +25,9 @@ HudWindow::HudWindow(UiController* ctrl, const QString& greenLogoPath, const QSt
         qCritical() << "[QML ERROR]" << e.toString();
 }
 
-void HudWindow::embedVideoWidget(QWidget* videoWidget)
+VideoSurfaceItem* HudWindow::videoSurface() const
 {
-    if (!videoWidget) return;
-    videoContainer_ = videoWidget;
-    videoContainer_->setParent(this);
-    videoContainer_->show();
-    syncVideoGeometry();
-}
-
-void HudWindow::resizeEvent(QResizeEvent* e)
-{
-    QQuickWidget::resizeEvent(e);
-    syncVideoGeometry();
+    return rootObject() ? rootObject()->findChild<VideoSurfaceItem*>("videoSurface") : nullptr;
 }
 
 bool HudWindow::inResizeZone(const QPoint& pos) const
@@ -81,18 +71,3 @@ void HudWindow::mouseReleaseEvent(QMouseEvent* e)
     }
     QQuickWidget::mouseReleaseEvent(e);
 }
-
-void HudWindow::syncVideoGeometry()
-{
-    if (!videoContainer_ || !rootObject()) return;
-
-    QQuickItem* area = rootObject()->findChild<QQuickItem*>("videoArea");
-    if (!area) return;
-
-    QPointF pos = area->mapToScene(QPointF(0, 0));
-    videoContainer_->setGeometry(
-        qRound(pos.x()), qRound(pos.y()),
-        qRound(area->width()), qRound(area->height())
-    );
-    videoContainer_->raise();
-}
@@ -5,25 +5,25 @@
 #include <QPoint>
 #include "uicontroller.h"
 
+class VideoSurfaceItem;
+
 class HudWindow : public QQuickWidget
 {
     Q_OBJECT
 public:
     explicit HudWindow(UiController* ctrl, const QString& greenLogoPath = {}, const QString& appIconDir = {}, QWidget* parent = nullptr);
-    void embedVideoWidget(QWidget* videoWidget);
+    // Main.qml 里的视频面（objectName "videoSurface"），与 HUD 同一场景图合成
+    VideoSurfaceItem* videoSurface() const;
 
 protected:
-    void resizeEvent(QResizeEvent* e) override;
     void mousePressEvent(QMouseEvent* e) override;
     void mouseMoveEvent(QMouseEvent* e) override;
     void mouseReleaseEvent(QMouseEvent* e) override;
     void mouseMoveEvent_cursor(QMouseEvent* e);
 
 private:
-    void syncVideoGeometry();
     bool inResizeZone(const QPoint& pos) const;
 
-    QWidget* videoContainer_ = nullptr;
     bool     resizing_       = false;
     QPoint   resizeStart_;
     QSize    sizeAtStart_;
@@ -0,0 +1,237 @@
+// ingestpipeline.cpp
+#include "ingestpipeline.h"
+
+#include <algorithm>
+#include <cmath>
+
+extern "C" {
+#include <gst/gst.h>
+}
+
+bool hasFactory(const char* name)
+{
+    GstElementFactory* f = gst_element_factory_find(name);
+    if (f) { gst_object_unref(f); return true; }
+    return false;
+}
+
+// 预览缩放：软解先在 I420 上缩放再转 BGRA（转换的像素更少）；d3d11 在 GPU 上一并完成
+static const char* kD3D11ToPreview =
+    "d3d11convert ! capsfilter name=pvcaps caps=\"video/x-raw(memory:D3D11Memory),format=BGRA\" "
+    "! d3d11download ! video/x-raw,format=BGRA";
+static const char* kSwToPreview =
+    "videoscale ! capsfilter name=pvcaps caps=video/x-raw ! videoconvert ! video/x-raw,format=BGRA";
+static const char* kD3D11ToBgra =
+    "d3d11convert ! video/x-raw(memory:D3D11Memory),format=BGRA ! d3d11download ! video/x-raw,format=BGRA";
+// Main10 码流 d3d11h265dec 输出 P010_10LE：先在 GPU 上转成 NV12 再下载，否则该分支协商失败，
+// 且 not-negotiated 会经 tee dt 使整条管线出错（即使 yuvvalve 关着）
+static const char* kD3D11ToYuv  =
+    "d3d11convert ! video/x-raw(memory:D3D11Memory),format=NV12 ! d3d11download ! video/x-raw,format=NV12";
+static const char* kSwToBgra    = "videoconvert ! video/x-raw,format=BGRA";
+static const char* kSwToYuv     = "videoconvert ! video/x-raw,format=I420";
+
+static std::vector<CodecChain> make_codec_table()
+{
+    std::vector<CodecChain> t = {
+        { VideoCodec::H264, "H264", "rtph264depay", "h264parse", "video/x-h264", {
+            { "d3d11(h264)->BGRA(download)", { "d3d11h264dec", "d3d11convert", "d3d11download" },
+              "d3d11h264dec", kD3D11ToPreview, kD3D11ToBgra, kD3D11ToYuv },
+            { "avdec_h264", { "avdec_h264", "videoconvert", "videoscale" },
+              "avdec_h264 max-threads={threads}", kSwToPreview, kSwToBgra, kSwToYuv },
+        } },
+        { VideoCodec::H265, "H265", "rtph265depay", "h265parse", "video/x-h265", {
+            { "d3d11(h265)->BGRA(download)", { "d3d11h265dec", "d3d11convert", "d3d11download" },
+              "d3d11h265dec", kD3D11ToPreview, kD3D11ToBgra, kD3D11ToYuv },
+            { "avdec_h265", { "avdec_h265", "videoconvert", "videoscale" },
+              "avdec_h265 max-threads={threads}", kSwToPreview, kSwToBgra, kSwToYuv },
+        } },
+    };
+    for (CodecChain& c : t) {
+        const bool base = hasFactory(c.depay) && hasFactory(c.parse);
+        for (DecoderCandidate& d : c.decoders) {
+            d.available = base;
+            for (const char* f : d.factories) d.available = d.available && hasFactory(f);
+        }
+    }
+    return t;
+}
+
+const CodecChain& codec_chain(VideoCodec codec)
+{
+    static const std::vector<CodecChain> table = make_codec_table();
+    for (const CodecChain& c : table)
+        if (c.codec == codec) return c;
+    return table.front();
+}
+
+const DecoderCandidate* best_decoder(const CodecChain& cc)
+{
+    for (const DecoderCandidate& d : cc.decoders)
+        if (d.available) return &d;
+    return nullptr;
+}
+
+const DecoderCandidate* find_decoder(const CodecChain& cc, const char* factory)
+{
+    if (!factory) return nullptr;
+    for (const DecoderCandidate& d : cc.decoders)
+        if (d.available && !d.factories.empty() && g_strcmp0(d.factories.front(), factory) == 0)
+            return &d;
+    return nullptr;
+}
+
+bool codec_from_encoding_name(const char* name, VideoCodec* out)
+{
+    if (!name) return false;
+    if (g_ascii_strcasecmp(name, "H264") == 0) { *out = VideoCodec::H264; return true; }
+    if (g_ascii_strcasecmp(name, "H265") == 0 || g_ascii_strcasecmp(name, "HEVC") == 0) {
+        *out = VideoCodec::H265;
+        return true;
+    }
+    return false;
+}
+
+const char* codec_name(VideoCodec c)
+{
+    return c == VideoCodec::H265 ? "H265" : "H264";
+}
+
+// -------------------------- Pipeline Builders (UDP) --------------------------
+
+// 压缩域队列：绝不能 leaky（丢压缩帧会破坏 H264 参考链 → 绿屏/花屏）。
+// leaky=no + 时间上限，满时对上游产生背压由 jitterbuffer 的 drop-on-latency 兜底。
+static const char* kPostSrcQueue =
+    "queue max-size-time=200000000 max-size-buffers=0 max-size-bytes=0 leaky=no";
+
+// Pre-decode queue（同为压缩域，leaky=no）
+static const char* kPreDecodeQueue =
+    "queue max-size-time=200000000 max-size-buffers=0 max-size-bytes=0 min-threshold-time=0 leaky=no";
+
+// 压缩域旁路（直通录像）：h264parse 后 tee 出 Annex-B AU，appsink 回调里立即取走，
+// 不会对解码分支形成背压。config-interval=-1 让每个 IDR 前都带 SPS/PPS（分段起点可独立解码）。
+// %1 = video/x-h264 | video/x-h265
+static const char* kEncodedTapBranch =
+    "queue max-size-time=1000000000 max-size-buffers=0 max-size-bytes=0 leaky=no "
+    "! %1,stream-format=byte-stream,alignment=au "
+    "! appsink name=esink emit-signals=false drop=false max-buffers=0 sync=false async=false";
+
+// 全分辨率 BGRA 分支：只在录像叠加/截图/放大超过 1:1 时打开 valve
+static const char* kFullResBranch =
+    "valve name=fullvalve drop=true "
+    "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
+    "! %1 "
+    "! appsink name=fullsink emit-signals=false drop=true max-buffers=2 sync=false async=false";
+
+// 平面 YUV 旁路（录像用）：valve 默认关闭，关闭时解码帧在 tee 后即丢弃，不做任何下载/转换
+static const char* kYuvTapBranch =
+    "valve name=yuvvalve drop=true "
+    "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
+    "! %1 "
+    "! appsink name=yuvsink emit-signals=false drop=true max-buffers=2 sync=false async=false";
+
+// 端到端延迟测量：jitterbuffer 收到 RTCP SR 后，按 SR 把 RTP 时间戳映射为发送端 NTP 墙钟，
+// 以 GstReferenceTimestampMeta(timestamp/x-ntp) 附在每个 buffer 上（GStreamer >= 1.22）。
+// 旧版本 rtspsrc 无此属性时不加，延迟统计自动缺省。
+static bool rtspsrc_has_property(const char* prop)
+{
+    GstElement* e = gst_element_factory_make("rtspsrc", nullptr);
+    if (!e) return false;
+    const bool has = g_object_class_find_property(G_OBJECT_GET_CLASS(e), prop) != nullptr;
+    gst_object_unref(e);
+    return has;
+}
+
+static QString rtspsrc_extra_props()
+{
+    static const bool refTsMeta = rtspsrc_has_property("add-reference-timestamp-meta");
+    return refTsMeta ? QStringLiteral("add-reference-timestamp-meta=true ") : QString();
+}
+
+// rtspsrc 源片段：video pad 由 RtspViewerQt 的 pad-added 处理函数连到 srcq（动态 pad，不写 "!"）。
+// drop-on-latency 作用于 rtspjitterbuffer（RTP 域，按整帧丢弃，解码安全）
+// 用于抑制长时延迟累积；运行时可由 setDropOnLatency() 切换（如怀疑启动异常可临时关闭）。
+QString rtsp_source_fragment(const QString& url, int latencyMs, bool dropOnLatency)
+{
+    return QString(
+               "rtspsrc name=src location=%1 protocols=udp latency=%2 buffer-mode=auto "
+               "udp-buffer-size=%3 do-retransmission=false drop-on-latency=%4 timeout=5000000 %5"
+               ).arg(url)
+        .arg(latencyMs)
+        .arg(kUdpRcvBufBytes)
+        .arg(dropOnLatency ? "true" : "false")
+        .arg(rtspsrc_extra_props());
+}
+
+// depay/parse/decoder 由 SDP 协商出的编码决定（见 codec table）。
+// decodeThreads: 软解 max-threads（0 = 自动，按核数）；多路时由会话管理器分配预算
+QString build_ingest_pipeline(const QString& source,
+                              const CodecChain& cc, const DecoderCandidate& dec, int decodeThreads)
+{
+    const QString decode = QString::fromLatin1(dec.decode)
+                               .replace("{threads}", QString::number(std::max(0, decodeThreads)));
+    return source + QString(
+               "%1 name=srcq "
+               "! %3 "
+               "! %4 config-interval=-1 "
+               "! tee name=et "
+               "et. ! %2 name=decq "
+               "! %5 "
+               "! tee name=dt "
+               "dt. ! valve name=pvvalve drop=false ! %6 "
+               "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
+               "! appsink name=sink drop=true max-buffers=2 sync=false "
+               "dt. ! %8 "
+               "dt. ! %7 "
+               "et. ! %9"
+               ).arg(kPostSrcQueue)
+        .arg(kPreDecodeQueue)
+        .arg(cc.depay)
+        .arg(cc.parse)
+        .arg(decode)
+        .arg(dec.toPreview)
+        .arg(QString(kYuvTapBranch).arg(dec.toYuv))
+        .arg(QString(kFullResBranch).arg(dec.toBgra))
+        .arg(QString(kEncodedTapBranch).arg(cc.tapCaps));
+}
+
+QString build_fallback_decodebin(const QString& source)
+{
+    return source + QString(
+               "%1 name=srcq "
+               "! decodebin "
+               "! videoconvert "
+               "! video/x-raw,format=BGRA "
+               "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
+               "! appsink name=sink drop=true max-buffers=2 sync=false"
+               ).arg(kPostSrcQueue);
+}
+
+QString build_pipeline_udp(const QString& url, int latencyMs, bool dropOnLatency,
+                           const CodecChain& cc, const DecoderCandidate& dec, int decodeThreads)
+{
+    return build_ingest_pipeline(rtsp_source_fragment(url, latencyMs, dropOnLatency), cc, dec, decodeThreads);
+}
+
+QString build_fallback_decodebin_udp(const QString& url, int latencyMs, bool dropOnLatency)
+{
+    return build_fallback_decodebin(rtsp_source_fragment(url, latencyMs, dropOnLatency));
+}
+
+// 预览分支目标宽度（0 = 不缩放）；已知源尺寸时按源宽高比给出偶数高度，否则由缩放元素保持 DAR 推出
+void apply_preview_width(GstElement* pvcaps, int width, int srcW, int srcH)
+{
+    GstCaps* cur = nullptr;
+    g_object_get(pvcaps, "caps", &cur, NULL);
+    GstCaps* caps = cur ? gst_caps_make_writable(cur) : gst_caps_new_empty_simple("video/x-raw");
+    GstStructure* st = gst_caps_get_structure(caps, 0);
+    gst_structure_remove_fields(st, "width", "height", "pixel-aspect-ratio", NULL);
+    if (width > 0) {
+        gst_structure_set(st, "width", G_TYPE_INT, width,
+                          "pixel-aspect-ratio", GST_TYPE_FRACTION, 1, 1, NULL);
+        if (srcW > 0 && srcH > 0)
+            gst_structure_set(st, "height", G_TYPE_INT,
+                              std::max(2, (int)std::lround((double)width * srcH / srcW) & ~1), NULL);
+    }
+    g_object_set(pvcaps, "caps", caps, NULL);
+    gst_caps_unref(caps);
+}
@@ -0,0 +1,65 @@
+// ingestpipeline.h
+// 拉流管线描述（gst_parse_launch 字符串）的构造：编码表、解码链候选与各分支片段。
+// RtspViewerQt 与离线基准（tools/ingest_bench）共用，保证测的就是线上管线。
+//
+// 管线 = 源片段 + 公共尾部：
+//   <source> queue name=srcq ! depay ! parse ! tee et
+//     et. ! queue decq（预解码队列）! decode ! tee dt
+//       dt. ! valve pvvalve ! 预览（pvcaps 缩放）! appsink sink
+//       dt. ! valve fullvalve ! 全分辨率 BGRA ! appsink fullsink
+//       dt. ! valve yuvvalve ! 平面 YUV ! appsink yuvsink
+//     et. ! 压缩域旁路 ! appsink esink
+// 源片段以 "! " 结尾时静态连接到 srcq；不以 "!" 结尾时（rtspsrc 等动态 pad）由调用方在 pad-added 中连接。
+// 调用前须已 gst_init。
+#pragma once
+
+#include <QString>
+#include <vector>
+
+#include "myStruct.h"
+
+struct _GstElement;
+
+static constexpr int kUdpRcvBufBytes = 16 * 1024 * 1024; // 16MB
+
+// 每种编码：depay/parse + 按优先级排列的解码链（首个工厂齐全者胜出）。
+// 工厂探测只做一次（注册表在进程内不会变化）。
+struct DecoderCandidate {
+    const char* tag;
+    std::vector<const char*> factories;
+    const char* decode;           // {threads} = 软解线程数
+    const char* toPreview;        // 解码输出 -> 按窗口缩放的 BGRA（预览，capsfilter pvcaps 可改宽高）
+    const char* toBgra;           // 解码输出 -> 全分辨率 BGRA（录像叠加/截图/放大）
+    const char* toYuv;            // 解码输出 -> 系统内存平面 YUV（录像，不经 RGB）
+    bool available = false;
+};
+
+struct CodecChain {
+    VideoCodec  codec;
+    const char* encodingName;     // SDP a=rtpmap encoding-name
+    const char* depay;
+    const char* parse;
+    const char* tapCaps;
+    std::vector<DecoderCandidate> decoders;
+};
+
+bool hasFactory(const char* name);
+
+const CodecChain& codec_chain(VideoCodec codec);
+// 首个工厂齐全的解码链；都不可用时 nullptr（走 decodebin 兜底）
+const DecoderCandidate* best_decoder(const CodecChain& cc);
+// 按解码器工厂名（如 "avdec_h264"）指定；不可用时 nullptr
+const DecoderCandidate* find_decoder(const CodecChain& cc, const char* factory);
+bool codec_from_encoding_name(const char* name, VideoCodec* out);
+const char* codec_name(VideoCodec c);
+
+QString rtsp_source_fragment(const QString& url, int latencyMs, bool dropOnLatency);
+QString build_ingest_pipeline(const QString& source,
+                              const CodecChain& cc, const DecoderCandidate& dec, int decodeThreads);
+QString build_fallback_decodebin(const QString& source);
+QString build_pipeline_udp(const QString& url, int latencyMs, bool dropOnLatency,
+                           const CodecChain& cc, const DecoderCandidate& dec, int decodeThreads);
+QString build_fallback_decodebin_udp(const QString& url, int latencyMs, bool dropOnLatency);
+
+// 运行中修改预览分支 capsfilter（pvcaps）的目标宽度（0 = 不缩放）
+void apply_preview_width(_GstElement* pvcaps, int width, int srcW, int srcH);
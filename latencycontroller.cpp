@@ -0,0 +1,75 @@
+#include "latencycontroller.h"
+
+#include <algorithm>
+#include <cmath>
+
+LatencyController::LatencyController()
+    : LatencyController(Config{})
+{
+}
+
+LatencyController::LatencyController(const Config& cfg)
+    : cfg_(cfg)
+{
+    cfg_.minMs = std::max(20, cfg_.minMs);
+    cfg_.maxMs = std::max(cfg_.minMs, cfg_.maxMs);
+    cur_ = std::clamp(cur_, cfg_.minMs, cfg_.maxMs);
+}
+
+void LatencyController::reset(int ms)
+{
+    cur_ = std::clamp(ms, cfg_.minMs, cfg_.maxMs);
+    cleanStreak_ = 0;
+    holdWindows_ = 0;
+    reason_ = QStringLiteral("initial");
+}
+
+// 抖动下限：4 倍平均抖动（近似覆盖 p99）+ 1 帧间隔 + 20ms 调度余量
+int LatencyController::jitterFloorMs(const Window& w) const
+{
+    const double f = 4.0 * w.netJitterMs + w.nominalGapMs + 20.0;
+    return std::clamp((int)std::ceil(f), cfg_.minMs, cfg_.maxMs);
+}
+
+bool LatencyController::update(const Window& w)
+{
+    const int prev = cur_;
+    const int floorMs = jitterFloorMs(w);
+
+    const double lossRate = w.pushed + w.lost > 0 ? (double)w.lost / (double)(w.pushed + w.lost) : 0.0;
+    const bool late   = w.late > 0;
+    const bool lossy  = lossRate > cfg_.lossRateToRaise;
+    const bool stalls = w.stalls >= cfg_.stallsToRaise;
+
+    if (holdWindows_ > 0) --holdWindows_;
+
+    if (late || lossy || stalls) {
+        cleanStreak_ = 0;
+        const int up = std::max({ cur_ + std::max(50, cur_ / 2), floorMs });
+        cur_ = std::min(up, cfg_.maxMs);
+        holdWindows_ = cfg_.holdAfterRaiseWindows;
+        reason_ = QString("raise: late=%1 lost=%2 (%3%) stalls=%4 jitter=%5ms")
+                      .arg(w.late)
+                      .arg(w.lost)
+                      .arg(lossRate * 100.0, 0, 'f', 2)
+                      .arg(w.stalls)
+                      .arg(w.netJitterMs, 0, 'f', 1);
+    } else if (cur_ < floorMs) {
+        cleanStreak_ = 0;
+        cur_ = floorMs;
+        holdWindows_ = cfg_.holdAfterRaiseWindows;
+        reason_ = QString("raise: jitter=%1ms floor=%2ms").arg(w.netJitterMs, 0, 'f', 1).arg(floorMs);
+    } else {
+        ++cleanStreak_;
+        if (holdWindows_ == 0 && cleanStreak_ >= cfg_.cleanWindowsToLower && cur_ > floorMs) {
+            cleanStreak_ = 0;
+            cur_ = std::max(cur_ - cfg_.stepDownMs, floorMs);
+            reason_ = QString("lower: clean %1 windows, jitter=%2ms floor=%3ms")
+                          .arg(cfg_.cleanWindowsToLower)
+                          .arg(w.netJitterMs, 0, 'f', 1)
+                          .arg(floorMs);
+        }
+    }
+
+    return cur_ != prev;
+}
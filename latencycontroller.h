@@ -0,0 +1,55 @@
+// latencycontroller.h
+// jitterbuffer 延迟自适应：每个统计窗口（~2 s）喂一次测量值，带迟滞地决定 rtspsrc latency。
+//   - 有迟到/丢包/卡顿：立即上调（至少 +50ms 或 +50%），之后保持一段时间不下调；
+//   - 连续若干个干净窗口：按步长下调，不低于 minMs，也不低于网络抖动决定的下限；
+//   - 当前值低于抖动下限：直接上调到下限。
+// 纯逻辑，不依赖 GStreamer；非线程安全（仅拉流线程使用）。
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+class LatencyController
+{
+public:
+    struct Config {
+        int minMs = 150;                 // 直连相机目标
+        int maxMs = 600;
+        int stepDownMs = 50;
+        int cleanWindowsToLower = 5;     // 连续干净窗口数（~10 s）后下调一步
+        int holdAfterRaiseWindows = 15;  // 上调后 ~30 s 内不下调
+        double lossRateToRaise = 0.002;  // 丢包率阈值（0.2%）
+        int stallsToRaise = 2;           // 单窗口卡顿次数阈值
+    };
+
+    // 单个统计窗口内的测量值（jitterbuffer 计数为窗口增量）
+    struct Window {
+        double  netJitterMs = 0.0;       // rtpjitterbuffer avg-jitter
+        double  nominalGapMs = 40.0;     // 1 / fps
+        quint64 pushed = 0;
+        quint64 lost = 0;
+        quint64 late = 0;
+        int     stalls = 0;              // 帧间隔 > 120ms 次数
+    };
+
+    LatencyController();
+    explicit LatencyController(const Config& cfg);
+
+    void reset(int ms);
+
+    // 返回 true 表示 latencyMs() 改变，reason() 给出原因
+    bool update(const Window& w);
+
+    int     latencyMs() const { return cur_; }
+    QString reason() const    { return reason_; }
+    const Config& config() const { return cfg_; }
+
+private:
+    int jitterFloorMs(const Window& w) const;
+
+    Config  cfg_;
+    int     cur_ = 350;
+    int     cleanStreak_ = 0;
+    int     holdWindows_ = 0;
+    QString reason_;
+};
@@ -0,0 +1,107 @@
+#include "latencyhistogram.h"
+
+#include <QtAlgorithms>
+#include <algorithm>
+
+int LatencyHistogram::bucketOf(quint64 v)
+{
+    if (v < (quint64)kSubBuckets) return (int)v;
+
+    const int e = 63 - qCountLeadingZeroBits(v);          // floor(log2(v)) >= kSubBits
+    if (e >= kMaxExp) return kBuckets - 1;
+
+    const int shift = e - kSubBits;
+    const int sub = (int)(v >> shift) - kSubBuckets;      // 0..31
+    return kSubBuckets + shift * kSubBuckets + sub;
+}
+
+double LatencyHistogram::bucketMidUs(int idx)
+{
+    if (idx < kSubBuckets) return (double)idx;
+
+    const int shift = (idx - kSubBuckets) / kSubBuckets;
+    const int sub   = (idx - kSubBuckets) % kSubBuckets;
+    const double lo    = (double)((quint64)(kSubBuckets + sub) << shift);
+    const double width = (double)(1ULL << shift);
+    return lo + width * 0.5;
+}
+
+void LatencyHistogram::record(qint64 us)
+{
+    if (us < 0) us = 0;
+    ++counts_[bucketOf((quint64)us)];
+    ++total_;
+    sum_ += (double)us;
+    if (us > max_) max_ = us;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& o)
+{
+    if (o.total_ == 0) return;
+    for (int i = 0; i < kBuckets; ++i) counts_[i] += o.counts_[i];
+    total_ += o.total_;
+    sum_ += o.sum_;
+    max_ = std::max(max_, o.max_);
+}
+
+void LatencyHistogram::reset()
+{
+    counts_.fill(0);
+    total_ = 0;
+    max_ = 0;
+    sum_ = 0.0;
+}
+
+double LatencyHistogram::percentileUs(double p01) const
+{
+    if (total_ == 0) return 0.0;
+
+    const double p = std::clamp(p01, 0.0, 1.0);
+    // 排名 1..total_
+    const quint64 rank = std::max<quint64>(1, (quint64)(p * (double)total_ + 0.5));
+    quint64 acc = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        acc += counts_[i];
+        if (acc >= rank) return std::min(bucketMidUs(i), (double)max_);
+    }
+    return (double)max_;
+}
+
+LatencySummary LatencyHistogram::summary() const
+{
+    LatencySummary s;
+    s.count = total_;
+    if (total_ == 0) return s;
+    s.p50Ms = percentileUs(0.50) / 1000.0;
+    s.p90Ms = percentileUs(0.90) / 1000.0;
+    s.p99Ms = percentileUs(0.99) / 1000.0;
+    s.maxMs = (double)max_ / 1000.0;
+    s.avgMs = meanUs() / 1000.0;
+    return s;
+}
+
+// ---------------------------------------------------------------------------
+
+RollingLatencyHistogram::RollingLatencyHistogram(int windows)
+    : wins_((size_t)std::max(1, windows))
+{
+}
+
+void RollingLatencyHistogram::rotate()
+{
+    cur_ = (cur_ + 1) % (int)wins_.size();
+    wins_[cur_].reset();
+}
+
+void RollingLatencyHistogram::reset()
+{
+    for (auto& w : wins_) w.reset();
+    cur_ = 0;
+}
+
+LatencyHistogram RollingLatencyHistogram::aggregate() const
+{
+    LatencyHistogram out;
+    for (const auto& w : wins_) out.merge(w);
+    return out;
+}
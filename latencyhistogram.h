@@ -0,0 +1,69 @@
+// latencyhistogram.h
+// 对数分桶直方图（HDR 风格）：固定内存、O(1) 记录，求分位数无需保存样本或排序，
+// 可在 release 版常开。单位 us；< 32us 精确计数，之上每个 2 倍区间分 32 桶（相对误差 ~3%），
+// 上限约 134 s（超出的计入最后一桶，max 仍精确）。非线程安全，由调用方保证单写者。
+#pragma once
+
+#include <QtGlobal>
+#include <array>
+#include <vector>
+
+// 对外发布的摘要（ms）
+struct LatencySummary {
+    quint64 count = 0;
+    double  p50Ms = 0.0;
+    double  p90Ms = 0.0;
+    double  p99Ms = 0.0;
+    double  maxMs = 0.0;
+    double  avgMs = 0.0;
+};
+
+class LatencyHistogram
+{
+public:
+    static constexpr int kSubBits    = 5;
+    static constexpr int kSubBuckets = 1 << kSubBits;   // 32
+    static constexpr int kMaxExp     = 27;              // 2^27 us ≈ 134 s
+    static constexpr int kBuckets    = kSubBuckets + (kMaxExp - kSubBits) * kSubBuckets;
+
+    void record(qint64 us);
+    void merge(const LatencyHistogram& o);
+    void reset();
+
+    quint64 count() const { return total_; }
+    qint64  maxUs() const { return total_ ? max_ : 0; }
+    double  meanUs() const { return total_ ? sum_ / (double)total_ : 0.0; }
+
+    // p01 ∈ [0,1]；返回所在桶的中点（us），max 桶直接返回精确最大值
+    double percentileUs(double p01) const;
+
+    LatencySummary summary() const;
+
+private:
+    static int    bucketOf(quint64 v);
+    static double bucketMidUs(int idx);
+
+    std::array<quint32, kBuckets> counts_{};
+    quint64 total_ = 0;
+    qint64  max_ = 0;
+    double  sum_ = 0.0;
+};
+
+// 滚动窗口：windows 个子窗口轮转，rotate() 丢弃最旧的一个。
+// current() 为当前子窗口，aggregate() 为全部子窗口合并。
+class RollingLatencyHistogram
+{
+public:
+    explicit RollingLatencyHistogram(int windows = 15);
+
+    void record(qint64 us) { wins_[cur_].record(us); }
+    void rotate();
+    void reset();
+
+    const LatencyHistogram& current() const { return wins_[cur_]; }
+    LatencyHistogram aggregate() const;
+
+private:
+    std::vector<LatencyHistogram> wins_;
+    int cur_ = 0;
+};
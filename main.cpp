@@ -16,8 +16,11 @@
 #include "udpserver.h"
 #include "myStruct.h"
 #include "languagemanager.h"
+#include "videosurfaceitem.h"
 #include <QQuickItem>
 #include <QQuickWidget>
+#include <QQuickWindow>
+#include <QSettings>
 #include <QQmlContext>
 #include <QQmlEngine>
 
@@ -116,6 +119,14 @@ int main(int argc, char* argv[])
                     "QLineEdit { color:#000000; background:#ffffff; }");
 
     qRegisterMetaType<myRecordOptions>("myRecordOptions");
+    qmlRegisterType<VideoSurfaceItem>("SPW.Video", 1, 0, "VideoSurface");
+
+    // ui/softwareRendering=true：无 GPU / 显卡驱动异常的工控机改用 software 场景图（视频面同样可用）
+    {
+        QSettings s("SPwater", "CameraControl");
+        if (s.value("ui/softwareRendering", false).toBool())
+            QQuickWindow::setSceneGraphBackend(QSGRendererInterface::Software);
+    }
 
     MainWindow w;
     UiController uiCtrl;
@@ -138,7 +149,7 @@ int main(int argc, char* argv[])
         if (!hud.isMaximized()) hud.move(hud.x() + dx, hud.y() + dy);
     });
 
-    if (w.videoView()) hud.embedVideoWidget(w.videoView());
+    w.setVideoSurface(hud.videoSurface());
 
     // 系统设置窗口
     SettingsController settingsCtrl;
@@ -149,7 +160,7 @@ int main(int argc, char* argv[])
     settingsWin.rootContext()->setContextProperty("uiCtrl", &uiCtrl);
     settingsWin.setSource(QUrl("qrc:/qml/Settings.qml"));
     settingsWin.setResizeMode(QQuickWidget::SizeRootObjectToView);
-    settingsWin.resize(480, 420);
+    settingsWin.resize(480, 454);
 
     QObject::connect(&settingsCtrl, &SettingsController::requestDrag, &settingsWin,
                      [&settingsWin](int dx, int dy){ settingsWin.move(settingsWin.x()+dx, settingsWin.y()+dy); });
@@ -11,7 +11,6 @@
 #include <QFileInfo>
 #include <QInputDialog>
 #include <QLineEdit>
-#include <QPainter>
 #include <QProgressDialog>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -19,28 +18,24 @@
 #include <QSettings>
 #include <QUrl>
 
+#include <cmath>
 #include <cstring>
 
 // ── 静态帧状态表（避免污染头文件）──────────────────────────────────────────
 static QHash<const MainWindow*, qint64> g_dropUntilMs;
-static QHash<const MainWindow*, int>    g_noFrameStreak;
 static QHash<const MainWindow*, qint64> g_lastNewFrameMs;
 static QHash<const MainWindow*, bool>   g_previewLoopOn;
 static QHash<const MainWindow*, qint64> g_streamStartMs;
 static QHash<const MainWindow*, qint64> g_viewerStartMs;
 
-static int calcNextPullIntervalMs(int streak)
-{
-    if (streak <= 2)  return 0;
-    if (streak <= 8)  return 2;
-    if (streak <= 20) return 8;
-    if (streak <= 60) return 16;
-    return 33;
-}
-
 // ── 叠加时间文字 ─────────────────────────────────────────────────────────────
-// 将 src 叠加时间戳后写入 dst（复用 dst 缓冲，避免每帧分配 8MB）
-static void applyOverlayInto(QImage& dst, const QImage& src, const QString& topText)
+// 将 src 叠加时间戳后写入 dst（截图用；源帧可能是解码器缓冲，只读，故先拷贝。
+// 录像不走这里：横幅由录像线程写在编码器输入上，见 VideoRecorder::setBurnOverlay）
+// 横幅由 overlay 缓存（每秒/文字变化时才重绘），这里只拷帧 + 写横幅矩形
+// scale：src 相对源分辨率的缩放（预览帧已缩放时 < 1），文字按同比例绘制，与录像画面观感一致
+// stampUtcUs: 叠加的时间（帧的采集/到达墙钟，见 FrameMeta::utcUs()），未知时用当前时间
+static void applyOverlayInto(QImage& dst, const QImage& src, OverlayStripCache& overlay,
+                             const QString& topText, qint64 stampUtcUs, double scale = 1.0)
 {
     // 仅在尺寸/格式不匹配时才重新分配，稳态下零分配
     if (dst.size() != src.size() || dst.format() != src.format())
@@ -49,20 +44,7 @@ static void applyOverlayInto(QImage& dst, const QImage& src, const QString& topT
     std::memcpy(dst.bits(), src.constBits(),
                 static_cast<size_t>(src.sizeInBytes()));
 
-    QPainter p(&dst);
-    p.setRenderHint(QPainter::TextAntialiasing);
-    const QFont font("Arial", 20, QFont::Bold);
-    p.setFont(font);
-    const QFontMetrics fm(font);
-    const int pad = 6;
-    const QString line = QDateTime::currentDateTime().toString("yyyy-MM-dd HH:mm:ss")
-                       + (topText.isEmpty() ? "" : "  " + topText);
-    const int w = fm.horizontalAdvance(line) + pad * 2;
-    const int h = fm.height() + pad * 2;
-    const QRect bg((dst.width() - w) / 2, 6, w, h);
-    p.fillRect(bg, Qt::black);
-    p.setPen(Qt::white);
-    p.drawText(bg, Qt::AlignCenter, line);
+    overlay.blendInto(dst, stampUtcUs, topText, scale);
 }
 
 // ── 构造 ─────────────────────────────────────────────────────────────────────
@@ -72,22 +54,19 @@ MainWindow::MainWindow(QWidget* parent)
 {
     setWindowFlags(Qt::FramelessWindowHint | Qt::WindowSystemMenuHint);
     qRegisterMetaType<QSharedPointer<QImage>>("QSharedPointer<QImage>");
+    qRegisterMetaType<QSharedPointer<EncodedPacket>>("QSharedPointer<EncodedPacket>");
+    qRegisterMetaType<QVector<QSharedPointer<EncodedPacket>>>("QVector<QSharedPointer<EncodedPacket>>");
+    qRegisterMetaType<QSharedPointer<YuvFrame>>("QSharedPointer<YuvFrame>");
+    qRegisterMetaType<FrameMeta>("FrameMeta");
 
     ui->setupUi(this);
 
-    // 用 ZoomPanImageView 替换 .ui 里的占位 label
-    if (ui->label) {
-        view_ = new ZoomPanImageView(ui->label->parentWidget());
-        view_->setObjectName(ui->label->objectName());
-        view_->setZoomRange(1.0, 3.0);
-        view_->setDisplayCrop(290, 290);
-        if (auto* lay = ui->label->parentWidget()->layout())
-            lay->replaceWidget(ui->label, view_);
-        ui->label->hide();
-        ui->label->deleteLater();
-        ui->label = nullptr;
-    }
-    if (view_) view_->installEventFilter(this);
+    // 预览分支缩放到视频面实际显示宽度（视频面由 HUD 创建，见 setVideoSurface）
+    previewResizeTimer_ = new QTimer(this);
+    previewResizeTimer_->setSingleShot(true);
+    connect(previewResizeTimer_, &QTimer::timeout, this, [this]{
+        if (viewer_ && view_) viewer_->setPreviewWidth(view_->fitPixelWidth());
+    });
 
     // 录像线程
     myVideoRecorder = new VideoRecorder;
@@ -95,17 +74,37 @@ MainWindow::MainWindow(QWidget* parent)
     myVideoRecorder->moveToThread(recThread_);
     recThread_->start();
 
+    // 拉流会话（多路并发，按 SN）
+    sessions_ = new StreamSessionManager(this);
+    connect(sessions_, &StreamSessionManager::logLine, this, [](const QString& sn, const QString& s){
+        qInfo().noquote() << QString("[%1] %2").arg(sn, s);
+    });
+    connect(sessions_, &StreamSessionManager::sessionOpened, this, [this](const QString&, RtspViewerQt* v){
+        // 压缩 AU 由 GStreamer 流线程发出，直接投递到录像线程（不经 GUI 线程）；
+        // 只有当前显示的会话会打开旁路
+        connect(v, &RtspViewerQt::encodedPacket, myVideoRecorder, &VideoRecorder::receiveEncodedPacket);
+        connect(v, &RtspViewerQt::encodedPreroll, myVideoRecorder, &VideoRecorder::receiveEncodedPreroll);
+        connect(v, &RtspViewerQt::yuvFrame, myVideoRecorder, &VideoRecorder::receiveYuvFrame2Record);
+    });
+
     // 恢复 overlay 设置
     {
         QSettings s("SPwater", "CameraControl");
         overlayEnabled_ = s.value("overlay/enabled", true).toBool();
         overlayTopText_ = s.value("overlay/topText", tr("双击改动文字信息")).toString();
+        recordPassthrough_ = s.value("record/passthrough", false).toBool();
+        preferSubStream_ = s.value("viewer/preferSubStream", true).toBool();
     }
 
     connect(this, &MainWindow::sendFrame2Capture, myVideoRecorder, &VideoRecorder::receiveFrame2Save);
     connect(this, &MainWindow::sendFrame2Record,  myVideoRecorder, &VideoRecorder::receiveFrame2Record);
     connect(this, &MainWindow::startRecord,       myVideoRecorder, &VideoRecorder::startRecording);
     connect(this, &MainWindow::stopRecord,        myVideoRecorder, &VideoRecorder::stopRecording);
+    connect(this, &MainWindow::setRecordPassthrough, myVideoRecorder, &VideoRecorder::setPassthrough);
+    connect(this, &MainWindow::setRecordYuvInput, myVideoRecorder, &VideoRecorder::setYuvInput);
+    connect(this, &MainWindow::setRecordBurnOverlay, myVideoRecorder, &VideoRecorder::setBurnOverlay);
+    connect(this, &MainWindow::setRecordOverlayMeta, myVideoRecorder, &VideoRecorder::setOverlayMetadata);
+    emit setRecordOverlayMeta(overlayTopText_);
 
     // UDP 设备发现
     mgr_ = new UdpDeviceManager(this);
@@ -129,135 +128,332 @@ MainWindow::MainWindow(QWidget* parent)
     connect(devAliveTimer_, &QTimer::timeout, this, &MainWindow::onCheckDeviceAlive);
     devAliveTimer_->start();
 
-    // 自适应拉帧定时器
-    previewPullTimer_ = new QTimer(this);
-    previewPullTimer_->setTimerType(Qt::PreciseTimer);
-    previewPullTimer_->setSingleShot(true);
-    connect(previewPullTimer_, &QTimer::timeout, this, [this](){
-        if (!viewer_ || !g_previewLoopOn.value(this, false)) {
-            g_previewLoopOn[this] = false;
-            g_noFrameStreak[this] = 0;
-            return;
+    // IP 修改超时定时器
+    ipChangeTimer_ = new QTimer(this);
+    ipChangeTimer_->setSingleShot(true);
+    connect(ipChangeTimer_, &QTimer::timeout, this, &MainWindow::onIpChangeTimeout);
+
+    // 主码流迟迟不出帧（地址错误、相机拒绝第二路会话等）时放弃本次录制，不让"等待中"无限挂着
+    recordStartTimer_ = new QTimer(this);
+    recordStartTimer_->setSingleShot(true);
+    recordStartTimer_->setInterval(8000);
+    connect(recordStartTimer_, &QTimer::timeout, this, [this]{
+        if (!recordStartPending_) return;
+        recordStartPending_ = false;
+        qWarning() << "[REC-START-FAIL] main stream produced no frame within"
+                   << recordStartTimer_->interval() << "ms, record start cancelled";
+        const QString msg = tr("主码流未能在 %1 秒内出画，录像未开始。请检查相机主码流地址或并发会话数限制。")
+                                .arg(recordStartTimer_->interval() / 1000);
+        if (uiCtrl_) uiCtrl_->appendLog(QDateTime::currentDateTime().toString("[hh:mm:ss] ") + msg);
+        ThemedMessageDialog::warning(this, tr("录像失败"), msg);
+    });
+}
+
+MainWindow::~MainWindow() { shutdownAllThreads(); delete ui; }
+
+// ── 帧到达（viewer 合并通知，每个新帧唤醒一次）──────────────────────────────
+void MainWindow::onPreviewFrameReady()
+{
+    if (!viewer_ || !g_previewLoopOn.value(this, false)) return;
+
+    ++previewWakeups_;
+    FrameMeta meta;
+    QSharedPointer<QImage> img = viewer_->takeLatestFrameIfNew(&meta);
+
+    // 双码流：预览拉子码流，需要全分辨率时按需拉起主码流。主码流首帧到达前
+    // 显示继续用子码流（放大时先看到低清画面），截图/录像等主码流就绪
+    const bool dual = sessions_->isDual(displayedSn_);
+    if (dual) sessions_->setMainWanted(displayedSn_, mainStreamWanted(), mainStreamDecodeWanted());
+    RtspViewerQt* fv = recordViewer();
+    if (dual && fv != preEventViewer_) applyPreEventBuffer();
+    if (recordStartPending_ && fv && !fv->sourceSize().isEmpty()) {
+        recordStartPending_ = false;
+        recordStartTimer_->stop();
+        beginRecording();
+    }
+
+    // 预览帧按窗口缩放；全分辨率分支只在 BGRA 重编码录像、截图、放大超过 1:1 时打开。
+    // 兜底管线没有全分辨率分支，预览帧本身就是全分辨率；主码流的预览分支只是缩略图，
+    // 没有全分辨率分支时取它的（未缩放的）预览帧。
+    const bool fvIsMain    = fv && fv != viewer_;
+    const bool fvHasBranch = fv && fv->fullResAvailable();
+    const bool hasFull     = fvIsMain || fvHasBranch;
+    const bool fullForRec  = isRecording_ && !recordPassthroughActive_ && !recordYuvActive_;
+    const bool fullForZoom = view_ && view_->zoom() > 1.0 + 1e-6;
+    if (fv) fv->setFullResEnabled(fvHasBranch && (fullForRec || iscapturing_ || fullForZoom));
+    // 录像/截图按录像来源自己的出帧节奏取帧：有全分辨率分支时听 fullFrameReady，
+    // 双码流主码流没有分支（兜底管线）时听它的 frameReady
+    setRecordSource(fvHasBranch || fvIsMain ? fv : nullptr);
+
+    const QSize srcSize = viewer_->sourceSize();
+    if (srcSize != lastSourceSize_) {
+        lastSourceSize_ = srcSize;
+        previewResizeTimer_->start(0);   // 源尺寸已知/变化：按当前窗口重新算预览宽度
+    }
+
+    // 绿帧由拉流端的 IDR 闸门挡掉（见 RtspViewerQt）；decodebin 兜底管线没有闸门，
+    // 开播后一小段仍按时间丢弃
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 until = g_dropUntilMs.value(this, 0);
+    if (img && !img->isNull() && until > 0 && now < until && !viewer_->idrGateAvailable())
+        img.reset();
+
+    if (img && !img->isNull()) {
+        g_lastNewFrameMs[this] = now;
+        lastFrameMs_ = now;
+        if (g_streamStartMs.value(this, 0) == 0) g_streamStartMs[this] = now;
+
+        // 帧率统计（1秒窗口）
+        if (fpsWindowStart_ == 0) fpsWindowStart_ = now;
+        fpsFrameCount_++;
+        if (now - fpsWindowStart_ >= 1000) {
+            lastFps_ = fpsFrameCount_;
+            fpsFrameCount_ = 0;
+            fpsWindowStart_ = now;
         }
 
-        QSharedPointer<QImage> img = viewer_->takeLatestFrameIfNew();
-        if (img && !img->isNull()) {
-            const qint64 now = QDateTime::currentMSecsSinceEpoch();
-            const qint64 until = g_dropUntilMs.value(this, 0);
-            if (!(until > 0 && now < until)) {
-                g_lastNewFrameMs[this] = now;
-                g_noFrameStreak[this] = 0;
-                lastFrameMs_ = now;
-                if (g_streamStartMs.value(this, 0) == 0) g_streamStartMs[this] = now;
-
-                // 帧率统计（1秒窗口）
-                if (fpsWindowStart_ == 0) fpsWindowStart_ = now;
-                fpsFrameCount_++;
-                if (now - fpsWindowStart_ >= 1000) {
-                    lastFps_ = fpsFrameCount_;
-                    fpsFrameCount_ = 0;
-                    fpsWindowStart_ = now;
-                }
-
-                if (view_) {
-                    QImage& disp = overlayDispBuf_[overlayDispIdx_];
-                    overlayDispIdx_ = (overlayDispIdx_ + 1) % 3;
-                    applyOverlayInto(disp, *img, overlayTopText_);
-                    view_->setImage(disp);
-                }
-
-                if (isRecording_) {
-                    if (overlayEnabled_) {
-                        // 录像跨线程：每帧独立分配一帧，避免与录像线程读缓冲竞争
-                        // （仍比原来 copy+create 少一次分配）
-                        auto rec = QSharedPointer<QImage>::create();
-                        applyOverlayInto(*rec, *img, overlayTopText_);
-                        emit sendFrame2Record(rec);
-                    } else {
-                        emit sendFrame2Record(img);
-                    }
-                }
-                if (iscapturing_) {
-                    if (overlayEnabled_) {
-                        // 截图非热路径，单独分配一帧即可
-                        auto snap = QSharedPointer<QImage>::create();
-                        applyOverlayInto(*snap, *img, overlayTopText_);
-                        emit sendFrame2Capture(snap);
-                    } else {
-                        emit sendFrame2Capture(img);
-                    }
-                    iscapturing_ = false;
-                }
-            } else {
-                g_noFrameStreak[this] = g_noFrameStreak.value(this, 0) + 1;
+        // 全分辨率帧按录像来源自己的通知取（onRecordFrameReady）；这里只用它缓存的最新一帧显示。
+        // 没有独立来源时（单码流兜底管线）预览帧本身就是全分辨率，录像/截图在这里按预览帧走
+        FrameMeta fullMeta = meta;
+        QSharedPointer<QImage> full;
+        if (recordSource_) {
+            full = viewFull_;
+            fullMeta = viewFullMeta_;
+        } else if (!dual) {
+            full = img;
+        }
+
+        if (view_) {
+            // 放大时优先显示全分辨率帧；分支刚打开、全分辨率帧未到时先用预览帧
+            const bool showFull = fullForZoom && hasFull && full;
+            if (showFull || !(fullForZoom && displayingFull_)) {
+                const QImage& src = showFull ? *full : *img;
+                const FrameMeta& srcMeta = showFull ? fullMeta : meta;
+                // 逻辑尺寸始终取预览流：主/子码流切换时视图不重置缩放
+                const QSize logical = srcSize.isEmpty() ? src.size() : srcSize;
+                // 池化帧原样交给视图；横幅是视图里单独的一层，只在每秒/文字变化时重新上传
+                view_->setImage(src, logical);
+                view_->setOverlayStrip(overlayDisp_.strip(srcMeta.utcUs(), overlayTopText_,
+                                                          (double)src.width() / logical.width(),
+                                                          src.format()));
+                displayingFull_ = showFull;
             }
-        } else {
-            g_noFrameStreak[this] = g_noFrameStreak.value(this, 0) + 1;
+            if (!fullForZoom) displayingFull_ = false;
+            if (meta.publishUs > 0) {
+                const qint64 lat = RtspViewerQt::monotonicUs() - meta.publishUs;
+                previewLatUsAcc_ += lat;
+                previewLatUsMax_ = qMax(previewLatUsMax_, lat);
+                ++previewPainted_;
+            }
+            if (meta.captureUtcUs > 0)
+                previewG2gHist_.record(RtspViewerQt::wallClockUtcUs() - meta.captureUtcUs);
         }
+        viewFull_.reset();   // 只显示一次，不占着解码缓冲
 
-        const int nextMs = (g_lastNewFrameMs.value(this, 0) == 0)
-                         ? qMin(calcNextPullIntervalMs(g_noFrameStreak.value(this, 0)), 8)
-                         : calcNextPullIntervalMs(g_noFrameStreak.value(this, 0));
-        if (g_previewLoopOn.value(this, false)) previewPullTimer_->start(nextMs);
-    });
+        if (!recordSource_ && !dual) deliverFullFrame(img, meta);
+    }
 
-    // IP 修改超时定时器
-    ipChangeTimer_ = new QTimer(this);
-    ipChangeTimer_->setSingleShot(true);
-    connect(ipChangeTimer_, &QTimer::timeout, this, &MainWindow::onIpChangeTimeout);
+    // 预览统计：唤醒次数 / 到达→绘制请求延迟（10 秒窗口）
+    const qint64 nowUs = RtspViewerQt::monotonicUs();
+    if (previewStatT0Us_ == 0) previewStatT0Us_ = nowUs;
+    if (nowUs - previewStatT0Us_ >= 10 * 1000 * 1000) {
+        const double sec = (nowUs - previewStatT0Us_) / 1e6;
+        const LatencySummary g2g = previewG2gHist_.summary();
+        qInfo().noquote() << QString("[PREVIEW] wakeups/s=%1 painted/s=%2 arrive->paint avg=%3ms max=%4ms | "
+                                     "capture->paint p50=%5ms p90=%6ms p99=%7ms max=%8ms n=%9")
+                                 .arg(previewWakeups_ / sec, 0, 'f', 1)
+                                 .arg(previewPainted_ / sec, 0, 'f', 1)
+                                 .arg(previewPainted_ ? previewLatUsAcc_ / 1000.0 / previewPainted_ : 0.0, 0, 'f', 2)
+                                 .arg(previewLatUsMax_ / 1000.0, 0, 'f', 2)
+                                 .arg(g2g.p50Ms, 0, 'f', 1)
+                                 .arg(g2g.p90Ms, 0, 'f', 1)
+                                 .arg(g2g.p99Ms, 0, 'f', 1)
+                                 .arg(g2g.maxMs, 0, 'f', 1)
+                                 .arg(g2g.count);
+        previewStatT0Us_ = nowUs;
+        previewWakeups_ = previewPainted_ = 0;
+        previewLatUsAcc_ = previewLatUsMax_ = 0;
+        previewG2gHist_.reset();
+    }
 }
 
-MainWindow::~MainWindow() { shutdownAllThreads(); delete ui; }
+// ── 录像来源（全分辨率帧）──────────────────────────────────────────────────
+// 录像/截图跟录像来源自己的出帧通知走，不再在预览（双码流即子码流）唤醒时顺带取：
+// viewer 只保留最新一帧，按子码流节奏取会把录像帧率压到 min(子码流, 主码流)
+void MainWindow::setRecordSource(RtspViewerQt* v)
+{
+    if (recordSource_ == v) return;
+    if (recordSource_) {
+        disconnect(recordSource_, &RtspViewerQt::fullFrameReady, this, &MainWindow::onRecordFrameReady);
+        if (recordSource_ != viewer_)
+            disconnect(recordSource_, &RtspViewerQt::frameReady, this, &MainWindow::onRecordFrameReady);
+    }
+    recordSource_ = v;
+    viewFull_.reset();
+    if (!v) return;
+    connect(v, &RtspViewerQt::fullFrameReady, this, &MainWindow::onRecordFrameReady, Qt::UniqueConnection);
+    if (v != viewer_)   // 主码流没有全分辨率分支时，它的预览帧就是全分辨率
+        connect(v, &RtspViewerQt::frameReady, this, &MainWindow::onRecordFrameReady, Qt::UniqueConnection);
+    // 连接前已到达的帧不会再通知，主动取一次
+    QMetaObject::invokeMethod(this, &MainWindow::onRecordFrameReady, Qt::QueuedConnection);
+}
+
+void MainWindow::onRecordFrameReady()
+{
+    RtspViewerQt* fv = recordSource_;
+    if (!fv || fv != recordViewer() || !g_previewLoopOn.value(this, false)) return;
+
+    FrameMeta fullMeta;
+    QSharedPointer<QImage> full = fv->fullResAvailable() ? fv->takeLatestFullFrameIfNew(&fullMeta)
+                                                         : fv->takeLatestFrameIfNew(&fullMeta);
+    if (!full || full->isNull()) return;
+
+    // 放大显示仍按预览唤醒绘制，这里只留最新一帧给它
+    if (view_ && view_->zoom() > 1.0 + 1e-6) {
+        viewFull_ = full;
+        viewFullMeta_ = fullMeta;
+    }
+    deliverFullFrame(full, fullMeta);
+}
+
+// 全分辨率帧 → 录像（BGRA 重编码）/ 截图
+void MainWindow::deliverFullFrame(const QSharedPointer<QImage>& full, const FrameMeta& fullMeta)
+{
+    // 叠加横幅由录像线程写在编码器输入上（见 VideoRecorder::setBurnOverlay），这里不拷帧
+    const bool fullForRec = isRecording_ && !recordPassthroughActive_ && !recordYuvActive_;
+    if (fullForRec) emit sendFrame2Record(full, fullMeta);
+    if (iscapturing_) {
+        if (overlayEnabled_) {
+            // 截图非热路径，单独分配一帧即可
+            auto snap = QSharedPointer<QImage>::create();
+            applyOverlayInto(*snap, *full, overlayFull_, overlayTopText_, fullMeta.utcUs());
+            emit sendFrame2Capture(snap, fullMeta);
+        } else {
+            emit sendFrame2Capture(full, fullMeta);
+        }
+        iscapturing_ = false;
+    }
+}
 
 void MainWindow::closeEvent(QCloseEvent* e) { shutdownAllThreads(); e->accept(); }
 
 void MainWindow::applyRecordOptions(const myRecordOptions& opt)
 {
     overlayEnabled_ = opt.overlayEnabled;
+    recordPassthrough_ = opt.recordPassthrough;
+    applyPreEventBuffer();
 }
 
-bool MainWindow::eventFilter(QObject* obj, QEvent* event)
+// 预录只对直通录像有意义（缓冲的是相机压缩码流）；挂在录像来源上，双码流即主码流。
+// record/preEventSeconds（默认 10，0 = 关）：双码流相机为此常开主码流 RTSP 会话（占带宽与相机
+// 并发会话数），但只收不解码（见 mainStreamDecodeWanted），解码 CPU 不增加
+void MainWindow::applyPreEventBuffer()
 {
-    if (obj == view_ && event->type() == QEvent::MouseButtonDblClick) {
-        QInputDialog dlg(this);
-        dlg.setWindowTitle(tr("编辑顶部文字"));
-        dlg.setLabelText(tr("顶部叠加文字："));
-        dlg.setTextValue(overlayTopText_);
-        dlg.setStyleSheet("QLineEdit { color: black; background: white; }");
-        if (dlg.exec() == QDialog::Accepted) {
-            overlayTopText_ = dlg.textValue();
-            QSettings s("SPwater", "CameraControl");
-            s.setValue("overlay/topText", overlayTopText_);
-        }
-        return true;
+    QSettings s("SPwater", "CameraControl");
+    preEventSec_ = recordPassthrough_ ? s.value("record/preEventSeconds", 10).toInt() : 0;
+    const qint64 bytes = s.value("record/preEventMaxMB", 64).toLongLong() * 1024 * 1024;
+
+    RtspViewerQt* rv = recordViewer();
+    if (preEventViewer_ && preEventViewer_ != rv) preEventViewer_->setPreEventBuffer(0, 0);
+    preEventViewer_ = rv;
+    if (rv) rv->setPreEventBuffer(preEventSec_, bytes);
+}
+
+RtspViewerQt* MainWindow::recordViewer() const
+{
+    return viewer_ ? sessions_->mainViewer(displayedSn_) : nullptr;
+}
+
+// 双码流何时需要主码流：录像（含等待开始）、截图、放大，以及开着预录（缓冲必须持续）
+bool MainWindow::mainStreamWanted() const
+{
+    return mainStreamDecodeWanted() || isRecording_ || preEventSec_ > 0;
+}
+
+// 其中需要解码主码流的：重编码录像、等待开始（要源尺寸）、截图、放大。只为预录/直通录像
+// 保持的主码流只收压缩码流、不解码，开预录不会让每路显示中的相机都解两路码流；
+// 代价是切到解码（截图/放大/重编码录像）时要等下一个 IDR（已请求关键帧，通常 < 1 s）
+bool MainWindow::mainStreamDecodeWanted() const
+{
+    return (isRecording_ && !recordPassthroughActive_) || recordStartPending_ || iscapturing_
+        || (view_ && view_->zoom() > 1.0 + 1e-6);
+}
+
+// HUD 场景图里的视频面（Main.qml 的 VideoSurface）
+void MainWindow::setVideoSurface(VideoSurfaceItem* v)
+{
+    if (view_ == v) return;
+    if (view_) disconnect(view_, nullptr, this, nullptr);
+    view_ = v;
+    if (!view_) return;
+
+    v->setZoomRange(1.0, 3.0);
+    v->setDisplayCrop(290, 290);
+    v->setCrosshairEnabled(crosshairEnabled_);
+    {
+        // 预缩放默认只在 software 场景图后端开启（OpenGL 后端由 GPU 缩放，预缩放只会多占 CPU）
+        QSettings s("SPwater", "CameraControl");
+        v->setPrescaleEnabled(s.value("ui/prescale", s.value("ui/softwareRendering", false)).toBool());
+    }
+    // 拖动改变窗口大小时合并：停下 200ms 后才重新协商预览尺寸
+    connect(v, &VideoSurfaceItem::viewResized, this, [this]{ previewResizeTimer_->start(200); });
+    connect(v, &VideoSurfaceItem::doubleClicked, this, &MainWindow::editOverlayTopText);
+}
+
+void MainWindow::editOverlayTopText()
+{
+    QInputDialog dlg(this);
+    dlg.setWindowTitle(tr("编辑顶部文字"));
+    dlg.setLabelText(tr("顶部叠加文字："));
+    dlg.setTextValue(overlayTopText_);
+    dlg.setStyleSheet("QLineEdit { color: black; background: white; }");
+    if (dlg.exec() == QDialog::Accepted) {
+        overlayTopText_ = dlg.textValue();
+        QSettings s("SPwater", "CameraControl");
+        s.setValue("overlay/topText", overlayTopText_);
+        emit setRecordOverlayMeta(overlayTopText_);
     }
-    return QMainWindow::eventFilter(obj, event);
 }
 
-// ── 拉帧定时器 ───────────────────────────────────────────────────────────────
-void MainWindow::startPreviewPullTimer()
+// ── 预览帧投递 ───────────────────────────────────────────────────────────────
+void MainWindow::startPreviewDelivery()
 {
     g_previewLoopOn[this] = true;
-    g_noFrameStreak[this] = 0;
-    if (!previewPullTimer_->isActive()) previewPullTimer_->start(0);
+    previewStatT0Us_ = 0;
+    previewWakeups_ = previewPainted_ = 0;
+    previewLatUsAcc_ = previewLatUsMax_ = 0;
+    previewG2gHist_.reset();
+    lastSourceSize_ = QSize();
+    displayingFull_ = false;
+    if (viewer_)
+        connect(viewer_, &RtspViewerQt::frameReady, this, &MainWindow::onPreviewFrameReady,
+                Qt::UniqueConnection);
+    // 启动前已到达的帧不会再通知，主动取一次
+    QMetaObject::invokeMethod(this, &MainWindow::onPreviewFrameReady, Qt::QueuedConnection);
 }
 
-void MainWindow::stopPreviewPullTimer()
+void MainWindow::stopPreviewDelivery()
 {
-    if (previewPullTimer_) previewPullTimer_->stop();
+    if (viewer_) {
+        disconnect(viewer_, &RtspViewerQt::frameReady, this, &MainWindow::onPreviewFrameReady);
+        viewer_->setFullResEnabled(false);
+        if (RtspViewerQt* rv = recordViewer()) rv->setFullResEnabled(false);
+    }
+    setRecordSource(nullptr);
     g_previewLoopOn[this] = false;
-    g_noFrameStreak[this] = 0;
 }
 
 // ── 设备存活检测 ─────────────────────────────────────────────────────────────
 void MainWindow::onCheckDeviceAlive()
 {
-    if (curSelectedSn_.isEmpty()) return;
+    // 多路时以当前显示的会话为准
+    const QString sn = viewer_ ? displayedSn_ : curSelectedSn_;
+    if (sn.isEmpty()) return;
     const qint64 now = QDateTime::currentMSecsSinceEpoch();
     const bool viewerRunning = (viewer_ != nullptr);
     const bool everGotFrame  = (g_streamStartMs.value(this, 0) > 0);
     const bool videoAlive    = (lastFrameMs_ > 0 && (now - lastFrameMs_) <= 1200);
-    const bool controlOnline = isControlOnline(curSelectedSn_);
+    const bool controlOnline = isControlOnline(sn);
     const bool uiOnline      = controlOnline && (!viewerRunning || videoAlive);
     const qint64 viewerStartMs = g_viewerStartMs.value(this, 0);
     const bool neverGotFrameTimeout = viewerRunning && !everGotFrame
@@ -270,8 +466,8 @@ void MainWindow::onCheckDeviceAlive()
             return;
         }
         if (isRecording_) on_action_stopRecord_triggered();
-        if (!offlinePopupShown_.value(curSelectedSn_, false)) {
-            offlinePopupShown_[curSelectedSn_] = true;
+        if (!offlinePopupShown_.value(sn, false)) {
+            offlinePopupShown_[sn] = true;
             QString dur = tr("未知");
             const qint64 t0 = g_streamStartMs.value(this, 0);
             if (t0 > 0) {
@@ -280,7 +476,7 @@ void MainWindow::onCheckDeviceAlive()
             }
             ThemedMessageDialog::openNonModal(this, tr("提示"),
                 tr("设备 [%1] 网络中断或视频断流。\n持续：%2。\n请检查网络后重新打开相机。")
-                    .arg(curSelectedSn_, dur));
+                    .arg(sn, dur));
         }
     }
 }
@@ -299,9 +495,13 @@ bool MainWindow::isControlOnline(const QString& sn, DeviceInfo* outDev) const
 bool MainWindow::openCameraForSelected(bool showMsgBox)
 {
     try {
-        g_noFrameStreak[this] = 0; g_lastNewFrameMs[this] = 0;
+        g_lastNewFrameMs[this] = 0;
         g_streamStartMs[this] = 0; g_viewerStartMs[this]  = 0;
-        if (viewer_) return true;
+        if (viewer_ && displayedSn_ == curSelectedSn_) return true;
+        if (sessions_->contains(curSelectedSn_)) {
+            displaySession(curSelectedSn_);
+            return true;
+        }
 
         if (curSelectedSn_.isEmpty()) {
             if (showMsgBox) ThemedMessageDialog::warning(this, tr("提示"), tr("请先在列表中选择一台相机。"));
@@ -313,19 +513,19 @@ bool MainWindow::openCameraForSelected(bool showMsgBox)
             return false;
         }
 
-        const QString url = QString("rtsp://%1:8554/%2").arg(dev.ip.toString(), curSelectedSn_);
-        qInfo().noquote() << "[UI] open rtsp url =" << url;
-
-        viewer_ = new RtspViewerQt(this);
-        lastFrameMs_ = 0;
-        g_noFrameStreak[this] = 0; g_lastNewFrameMs[this] = 0;
-        g_dropUntilMs[this]   = QDateTime::currentMSecsSinceEpoch() + 800;
-        g_viewerStartMs[this] = QDateTime::currentMSecsSinceEpoch();
-
-        connect(viewer_, &RtspViewerQt::logLine, this, [](const QString& s){ qInfo().noquote() << s; });
-        viewer_->setUrl(url);
-        viewer_->start();
-        startPreviewPullTimer();
+        // 心跳未声明路径时按 /SN；声明了子码流时预览走子码流，主码流按需拉起
+        const QString base = QString("rtsp://%1:%2").arg(dev.ip.toString()).arg(dev.rtspPort);
+        const QString mainPath = dev.rtspPath.isEmpty() ? "/" + curSelectedSn_ : dev.rtspPath;
+        const QString url = base + mainPath;
+        const bool useSub = preferSubStream_ && !dev.rtspSubPath.isEmpty();
+        const QString subUrl = useSub ? base + dev.rtspSubPath : QString();
+        qInfo().noquote() << "[UI] open rtsp url =" << url
+                          << (useSub ? QString("(preview sub = %1)").arg(subUrl) : QString());
+
+        // 其他 SN 的会话保持运行（后台只解码不出预览帧），只切换显示
+        if (useSub) sessions_->open(curSelectedSn_, subUrl, url);
+        else        sessions_->open(curSelectedSn_, url);
+        displaySession(curSelectedSn_);
         return true;
     } catch (const std::exception& e) {
         qCritical() << "[UI] openCameraForSelected exception:" << e.what();
@@ -344,17 +544,49 @@ bool MainWindow::openCameraForSelected(bool showMsgBox)
     }
 }
 
+// 关闭当前显示的会话（其他会话不受影响）
 void MainWindow::doStopViewer()
 {
-    stopPreviewPullTimer();
+    stopPreviewDelivery();
     if (!viewer_) return;
-    RtspViewerQt* v = viewer_;
+    const QString sn = displayedSn_;
+    recordStartPending_ = false;
     viewer_ = nullptr;
+    displayedSn_.clear();
     lastFrameMs_ = 0;
     g_streamStartMs[this] = 0;
     g_viewerStartMs[this] = 0;
-    connect(v, &QThread::finished, v, &QObject::deleteLater);
-    v->stop(); v->quit(); v->wait(1200);
+    sessions_->close(sn);
+    sessions_->setDisplayed(QString());
+}
+
+// 切换显示到已打开的会话：预览投递、预录缓冲、录像源都跟随显示的那一路
+void MainWindow::displaySession(const QString& sn)
+{
+    RtspViewerQt* v = sessions_->viewer(sn);
+    if (!v || v == viewer_) return;
+
+    if (isRecording_ || recordStartPending_) on_action_stopRecord_triggered();
+    stopPreviewDelivery();
+    if (preEventViewer_) preEventViewer_->setPreEventBuffer(0, 0);
+    preEventViewer_ = nullptr;
+    // 不再显示的那一路不需要主码流（后台会话只保留子码流）
+    if (viewer_) sessions_->releaseMain(displayedSn_);
+
+    viewer_ = v;
+    displayedSn_ = sn;
+    sessions_->setDisplayed(sn);
+    lastFrameMs_ = 0;
+    fpsFrameCount_ = 0;
+    fpsWindowStart_ = 0;
+    g_lastNewFrameMs[this] = 0;
+    g_streamStartMs[this] = 0;
+    g_dropUntilMs[this]   = QDateTime::currentMSecsSinceEpoch() + 800;
+    g_viewerStartMs[this] = QDateTime::currentMSecsSinceEpoch();
+    qInfo().noquote() << QString("[SESSION] display %1 (open=%2)").arg(sn).arg(sessions_->count());
+
+    applyPreEventBuffer();
+    startPreviewDelivery();
 }
 
 void MainWindow::on_action_openCamera_triggered()  { openCameraForSelected(true); }
@@ -363,7 +595,6 @@ void MainWindow::on_action_closeCamera_triggered()
 {
     doStopViewer();
     g_previewLoopOn[this] = false;
-    g_noFrameStreak[this] = 0;
     g_lastNewFrameMs[this] = 0;
 }
 
@@ -373,33 +604,77 @@ void MainWindow::on_action_startRecord_triggered()
 {
     qInfo() << "[REC-UI] record button clicked isRecording_=" << isRecording_
             << "viewer=" << (viewer_ != nullptr);
-    if (isRecording_) {
-        qWarning() << "[REC-START-FAIL] isRecording_ already true, ignoring click";
+    if (isRecording_ || recordStartPending_) {
+        qWarning() << "[REC-START-FAIL] recording already started/pending, ignoring click";
         return;
     }
     if (!viewer_) {
         ThemedMessageDialog::information(this, tr("提示"), tr("请先打开相机预览再开始录制。"));
         return;
     }
+    // 双码流：主码流未就绪时先拉起，首帧到达后由 onPreviewFrameReady 开始录制
+    RtspViewerQt* rv = recordViewer();
+    if (!rv || rv->sourceSize().isEmpty()) {
+        qInfo() << "[REC-UI] main stream not ready, recording starts on its first frame";
+        recordStartPending_ = true;
+        recordStartTimer_->start();
+        sessions_->setMainWanted(displayedSn_, true);
+        return;
+    }
+    beginRecording();
+}
+
+void MainWindow::beginRecording()
+{
+    RtspViewerQt* rv = recordViewer();
+    if (!rv) return;
     isRecording_ = true;
+
+    // 直通录像需要管线带压缩域旁路（decodebin 兜底管线没有），否则回退为重编码
+    recordPassthroughActive_ = recordPassthrough_ && rv->encodedTapAvailable();
+    if (recordPassthrough_ && !recordPassthroughActive_)
+        qWarning() << "[REC-UI] passthrough requested but pipeline has no encoded tap, fallback to re-encode";
+    // 重编码录像直接取解码器的平面 YUV，省掉 BGRA->YUV 转换；叠加横幅由录像线程写在 YUV 上。
+    // 录制中切换叠加开关从下一次录制生效
+    recordYuvActive_ = !recordPassthroughActive_ && rv->yuvTapAvailable();
+    emit setRecordPassthrough(recordPassthroughActive_);
+    emit setRecordYuvInput(recordYuvActive_);
+    emit setRecordBurnOverlay(overlayEnabled_);
     emit startRecord();
+    // 必须在 startRecord 之后：启用旁路时先投递预录 AU，录像线程按顺序处理
+    rv->setEncodedTapEnabled(recordPassthroughActive_);
+    rv->setYuvTapEnabled(recordYuvActive_);
 }
 
 void MainWindow::on_action_stopRecord_triggered()
 {
+    if (recordStartPending_) {
+        recordStartPending_ = false;
+        qInfo() << "[REC-UI] pending record start cancelled";
+        return;
+    }
     if (!isRecording_) return;
     isRecording_ = false;
-
+    if (RtspViewerQt* rv = recordViewer()) {
+        rv->setEncodedTapEnabled(false);
+        rv->setYuvTapEnabled(false);
+    }
+    recordPassthroughActive_ = false;
+    recordYuvActive_ = false;
     recSaveDlg_ = new QProgressDialog(tr("正在保存录像，请稍候..."), QString(), 0, 0, this);
     recSaveDlg_->setWindowModality(Qt::WindowModal);
     recSaveDlg_->setCancelButton(nullptr);
     recSaveDlg_->show();
 
-    auto* conn = new QMetaObject::Connection;
-    *conn = connect(myVideoRecorder, &VideoRecorder::recordingStopped, this, [this, conn](){
+    // stopRecording 总会发 recordingStopped（未生成文件时路径为空）；打开失败走 recordingFailed，同样关闭
+    auto conns = QSharedPointer<QVector<QMetaObject::Connection>>::create();
+    auto closeDlg = [this, conns](){
         if (recSaveDlg_) { recSaveDlg_->close(); recSaveDlg_->deleteLater(); recSaveDlg_ = nullptr; }
-        disconnect(*conn); delete conn;
-    });
+        for (const auto& c : *conns) disconnect(c);
+        conns->clear();
+    };
+    conns->append(connect(myVideoRecorder, &VideoRecorder::recordingStopped, this, closeDlg));
+    conns->append(connect(myVideoRecorder, &VideoRecorder::recordingFailed,  this, closeDlg));
     emit stopRecord();
 }
 
@@ -411,7 +686,8 @@ void MainWindow::changeIp(const QString& sn, const QString& newIp)
         ThemedMessageDialog::warning(nullptr, tr("错误"), tr("IP 地址格式不正确。"));
         return;
     }
-    if (curSelectedSn_ == sn && viewer_) doStopViewer();
+    if (displayedSn_ == sn && viewer_) doStopViewer();
+    else if (sessions_->contains(sn)) sessions_->close(sn);
 
     const qint64 n = mgr_->sendSetIp(sn, newIp, 16);
     if (n <= 0) { ThemedMessageDialog::warning(nullptr, tr("错误"), tr("发送改 IP 命令失败。")); return; }
@@ -525,6 +801,8 @@ void MainWindow::bindUiController(UiController* ctrl)
     connect(ctrl, &UiController::requestSelectDevice,  this, [this](const QString& sn){
         curSelectedSn_ = sn;
         offlinePopupShown_.remove(sn);
+        // 该 SN 已有会话在跑：直接切换显示
+        if (sessions_->contains(sn)) displaySession(sn);
     });
     connect(ctrl, &UiController::requestOpenFolder, this, [this](){
         QDesktopServices::openUrl(QUrl::fromLocalFile("D:/SP_camera_record"));
@@ -533,6 +811,7 @@ void MainWindow::bindUiController(UiController* ctrl)
         emit sendCameraExporeGain(curSelectedSn_, 0, ctrl->brightness());
     });
     connect(ctrl, &UiController::requestToggleCrosshair, this, [this](bool en){
+        crosshairEnabled_ = en;
         if (view_) view_->setCrosshairEnabled(en);
     });
 
@@ -605,12 +884,19 @@ void MainWindow::bindUiController(UiController* ctrl)
         ctrl->setRecordSegmentIndex(0);
         ctrl->setRecordSegmentElapsed("00:00");
         ctrl->setRecordTotalElapsed("00:00");
-        ctrl->appendLog(QDateTime::currentDateTime().toString("[hh:mm:ss] ") + "录像已保存：" + QFileInfo(path).fileName());
+        if (!path.isEmpty())
+            ctrl->appendLog(QDateTime::currentDateTime().toString("[hh:mm:ss] ") + "录像已保存：" + QFileInfo(path).fileName());
     });
     // Reset isRecording_ when encoder init fails so the user can retry
     connect(myVideoRecorder, &VideoRecorder::recordingFailed, this, [this](const QString& reason){
         qWarning() << "[REC-STATE] recordingFailed, resetting isRecording_. reason=" << reason;
         isRecording_ = false;
+        recordPassthroughActive_ = false;
+        recordYuvActive_ = false;
+        if (RtspViewerQt* rv = recordViewer()) {
+            rv->setEncodedTapEnabled(false);
+            rv->setYuvTapEnabled(false);
+        }
     });
     connect(myVideoRecorder, &VideoRecorder::sendMSG2ui, ctrl, [ctrl](const QString& msg){
         ctrl->appendLog(QDateTime::currentDateTime().toString("[hh:mm:ss] ") + msg);
@@ -627,6 +913,14 @@ void MainWindow::bindUiController(UiController* ctrl)
         if (mgr_) ctrl->setDeviceList(mgr_->allSns());
         ctrl->setSelectedSn(curSelectedSn_);
         ctrl->setCurrentFps(lastFps_);
+        if (viewer_) {
+            // 拉流线程每 ~2 s 发布一次；这里只读快照
+            const StreamStats st = viewer_->streamStats();
+            ctrl->setRtpStats(st.netLostPerSec, st.jbLostPerSec, st.jbLatePerSec, st.jbDupPerSec,
+                              st.jbJitterMs, (double)st.poolDrops);
+        } else {
+            ctrl->setRtpStats(0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+        }
         // 收到第一帧后清除 connecting 状态
         if (ctrl->connecting() && lastFrameMs_ > 0
             && (QDateTime::currentMSecsSinceEpoch() - lastFrameMs_) <= 1200) {
@@ -639,14 +933,13 @@ void MainWindow::bindUiController(UiController* ctrl)
 // ── 关闭 ─────────────────────────────────────────────────────────────────────
 void MainWindow::shutdownAllThreads()
 {
-    if (previewPullTimer_) previewPullTimer_->stop();
+    stopPreviewDelivery();
     if (devAliveTimer_)    devAliveTimer_->stop();
     if (ipChangeTimer_)    ipChangeTimer_->stop();
 
-    if (viewer_) {
-        RtspViewerQt* v = viewer_; viewer_ = nullptr;
-        v->stop(); v->quit(); v->wait(2000); v->deleteLater();
-    }
+    viewer_ = nullptr;
+    displayedSn_.clear();
+    if (sessions_) sessions_->closeAll(2000);
     if (recThread_) {
         if (isRecording_ && myVideoRecorder) {
             QProgressDialog dlg(tr("正在保存录像..."), QString(), 0, 0, this);
@@ -657,8 +950,8 @@ void MainWindow::shutdownAllThreads()
         }
         recThread_->quit(); recThread_->wait(5000); recThread_ = nullptr;
     }
-    g_dropUntilMs.remove(this); g_previewLoopOn.remove(this);
-    g_noFrameStreak.remove(this); g_lastNewFrameMs.remove(this);
+    g_previewLoopOn.remove(this);
+    g_dropUntilMs.remove(this); g_lastNewFrameMs.remove(this);
     g_streamStartMs.remove(this); g_viewerStartMs.remove(this);
     offlinePopupShown_.clear();
 }
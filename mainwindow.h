@@ -7,13 +7,16 @@
 #include <QSharedPointer>
 #include <QHash>
 #include <QDateTime>
+#include <QPointer>
 
 #include "udpserver.h"
 #include "rtspviewerqt.h"
-#include "ZoomPanImageView.h"
+#include "streamsessionmanager.h"
+#include "videosurfaceitem.h"
 #include "videorecorder.h"
 #include "uicontroller.h"
 #include "myStruct.h"
+#include "overlaystripcache.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -27,7 +30,7 @@ public:
     ~MainWindow() override;
 
     void bindUiController(UiController* ctrl);
-    ZoomPanImageView* videoView()             const { return view_; }
+    void              setVideoSurface(VideoSurfaceItem* v);
     VideoRecorder*    myVideoRecorderPublic() const { return myVideoRecorder; }
     UdpDeviceManager* deviceManager()         const { return mgr_; }
 
@@ -37,13 +40,17 @@ public slots:
 
 protected:
     void closeEvent(QCloseEvent* event) override;
-    bool eventFilter(QObject* obj, QEvent* event) override;
 
 signals:
-    void sendFrame2Record(QSharedPointer<QImage> img);
-    void sendFrame2Capture(QSharedPointer<QImage> img);
+    // meta: 帧元数据（见 FrameMeta），录像 PTS / 截图命名按它而不是录像线程的出队时刻
+    void sendFrame2Record(QSharedPointer<QImage> img, FrameMeta meta);
+    void sendFrame2Capture(QSharedPointer<QImage> img, FrameMeta meta);
     void startRecord();
     void stopRecord();
+    void setRecordPassthrough(bool on);
+    void setRecordYuvInput(bool on);
+    void setRecordBurnOverlay(bool on);
+    void setRecordOverlayMeta(const QString& text);
     qint64 sendCameraExporeGain(const QString& sn, int exposureUs, double gainDb);
 
 private slots:
@@ -56,26 +63,41 @@ private slots:
     void onSnUpdatedForIpChange(const QString& sn);
     void onIpChangeTimeout();
     void onSetIpAckReceived(const QString& sn, const QString& status);
+    void onPreviewFrameReady();
+    void onRecordFrameReady();
+    void editOverlayTopText();
 
 private:
-    void startPreviewPullTimer();
-    void stopPreviewPullTimer();
+    void startPreviewDelivery();
+    void stopPreviewDelivery();
     void doStopViewer();
+    void displaySession(const QString& sn);
     void shutdownAllThreads();
     bool openCameraForSelected(bool showMsgBox);
     bool isControlOnline(const QString& sn, DeviceInfo* outDev = nullptr) const;
     void finishIpChange(bool ok, const QString& msg);
+    void applyPreEventBuffer();
+    void beginRecording();
+    RtspViewerQt* recordViewer() const;     // 全分辨率 / 录像来源：双码流为主码流，否则即 viewer_
+    bool mainStreamWanted() const;
+    bool mainStreamDecodeWanted() const;
+    void setRecordSource(RtspViewerQt* v);
+    void deliverFullFrame(const QSharedPointer<QImage>& full, const FrameMeta& fullMeta);
 
 private:
     Ui::MainWindow* ui = nullptr;
-    ZoomPanImageView* view_ = nullptr;
+    QPointer<VideoSurfaceItem> view_;       // HUD 场景图里的视频面（随 QML 销毁）
     UdpDeviceManager* mgr_ = nullptr;
+    // 多路会话；viewer_ 指向当前显示（并供录像）的那一路，displayedSn_ 为其 SN
+    StreamSessionManager* sessions_ = nullptr;
     RtspViewerQt* viewer_ = nullptr;
+    QString       displayedSn_;
 
     QTimer* devAliveTimer_ = nullptr;
-    QTimer* previewPullTimer_ = nullptr;
     QTimer* ipChangeTimer_ = nullptr;
+    QTimer* recordStartTimer_ = nullptr;    // 双码流：等主码流首帧的超时
     QTimer* triggerAckTimer_ = nullptr;
+    QTimer* previewResizeTimer_ = nullptr;
 
     VideoRecorder* myVideoRecorder = nullptr;
     QThread* recThread_ = nullptr;
@@ -83,11 +105,19 @@ private:
 
     bool    isRecording_ = false;
     bool    iscapturing_ = false;
+    bool    crosshairEnabled_ = false;
     qint64  lastFrameMs_ = 0;
 
     QString curSelectedSn_;
     QString overlayTopText_;
     bool    overlayEnabled_ = false;
+    bool    recordPassthrough_       = false;   // 设置项
+    bool    recordPassthroughActive_ = false;   // 当前录制是否走压缩域直通
+    bool    recordYuvActive_         = false;   // 当前录制是否直接取解码器平面 YUV
+    bool    recordStartPending_      = false;   // 双码流：已点录制，等主码流出第一帧再开始
+    int     preEventSec_             = 0;
+    QPointer<RtspViewerQt> preEventViewer_;     // 当前挂着预录缓冲的 viewer（主码流按需启停）
+    bool    preferSubStream_         = true;    // viewer/preferSubStream：相机有子码流时预览走子码流
 
     bool    ipChangeWaiting_  = false;
     bool    ipAckAccepted_    = false;
@@ -102,8 +132,24 @@ private:
     qint64 fpsWindowStart_ = 0;
     int    lastFps_        = 0;
 
-    // overlay 复用缓冲区（避免每帧分配 8-16MB 导致长时内存碎片化）
-    // 3 槽：防止 update() 异步 paint 仍在读某槽时被下一帧 memcpy 覆盖
-    QImage overlayDispBuf_[3];              // 显示 overlay 三缓冲
-    int    overlayDispIdx_ = 0;
+    // 预览投递统计（唤醒次数 / 到达→绘制请求延迟）
+    qint64 previewStatT0Us_  = 0;
+    int    previewWakeups_   = 0;
+    int    previewPainted_   = 0;
+    qint64 previewLatUsAcc_  = 0;
+    qint64 previewLatUsMax_  = 0;
+    LatencyHistogram previewG2gHist_;       // 采集（RTCP SR 墙钟）→ 绘制请求
+
+    // 预览缩放 / 全分辨率分支
+    QSize  lastSourceSize_;
+    bool   displayingFull_ = false;         // 当前显示的是全分辨率帧（放大中）
+    // 录像/截图的全分辨率帧来源（按它自己的出帧通知取帧）；放大时它的最新帧留给下次预览绘制
+    QPointer<RtspViewerQt> recordSource_;
+    QSharedPointer<QImage> viewFull_;
+    FrameMeta              viewFullMeta_;
+
+    // 叠加横幅缓存：显示（按预览缩放，由视图作为独立图层绘制）与截图（源分辨率，烧进帧）
+    // 比例不同，各用一个，避免每帧重绘。录像的横幅由录像线程自己的缓存写在编码器输入上
+    OverlayStripCache overlayDisp_;
+    OverlayStripCache overlayFull_;
 };
@@ -1,7 +1,10 @@
 #ifndef MYSTRUCT_H
 #define MYSTRUCT_H
 #include <QString>
+#include <QByteArray>
 #include <QMetaType>
+#include <QSharedPointer>
+#include <QVector>
 
 #define mp4 101
 #define avi 102
@@ -18,6 +21,11 @@ enum class ImageFormat {
     JPG,
     BMP
 };
+enum class VideoCodec {
+    H264,
+    H265
+};
+
 struct myRecordOptions {
 
     QString capturePath;
@@ -25,10 +33,59 @@ struct myRecordOptions {
     ImageFormat  capturType;
     VideoContainer  recordType;
     bool overlayEnabled = false;
+    bool recordPassthrough = false;   // 直通录像：不解码不重编码，直接封装相机 H264/H265
+
+};
+
+// 压缩域访问单元（h264parse/h265parse 之后：Annex-B 字节流，按 AU 对齐，IDR 前带 (VPS/)SPS/PPS）
+struct EncodedPacket {
+    QByteArray data;
+    qint64 ptsUs      = -1;   // GstBuffer PTS（微秒，流内时间）
+    qint64 dtsUs      = -1;
+    qint64 durationUs = 0;
+    bool   keyframe   = false;
+    int    width      = 0;
+    int    height     = 0;
+    qint64 captureUtcUs = -1; // 发送端采集墙钟（RTCP SR 映射，Unix 纪元 UTC 微秒），未知为 -1
+    VideoCodec codec  = VideoCodec::H264;
+};
+
+// 逐帧元数据：随每个解码帧交给预览/录像/截图，时间取自接收链路各环节，而不是消费者出队时刻。
+// *Us 为 RtspViewerQt::monotonicUs()（steady clock），*UtcUs 为 Unix 纪元 UTC 微秒。
+struct FrameMeta {
+    QString sn;                 // 来源相机
+    qint64  ptsNs        = -1;  // GstBuffer PTS（由 RTP 时间戳换算，重连后不连续）
+    quint32 rtpTimestamp = 0;   // RTP 时间戳（90 kHz），rtpSeq<0 时无效
+    int     rtpSeq       = -1;  // 该帧最后一个 RTP 包的序号，-1 = 未知
+    qint64  arrivalUs    = 0;   // 首个 RTP 包出 jitterbuffer、进入 depay 的时刻
+    qint64  arrivalUtcUs = -1;  // 同一时刻的墙钟
+    qint64  decodeDoneUs = 0;   // 解码器输出该帧的时刻
+    qint64  publishUs    = 0;   // 交付给消费者（appsink 取出）的时刻
+    qint64  captureUtcUs = -1;  // 发送端采集墙钟（RTCP SR 映射），未知为 -1
+
+    // 帧时间：优先发送端采集时刻，其次本机到达时刻；都未知返回 -1
+    qint64 utcUs() const { return captureUtcUs > 0 ? captureUtcUs : arrivalUtcUs; }
+};
 
+// 解码器输出的平面 YUV 帧（I420：Y/U/V 三平面；NV12：Y + 交错 UV 两平面）。
+// 平面指针直接指向解码后的 GstBuffer 映射内存，最后一个 QSharedPointer 释放时解除映射并归还缓冲；
+// 消费者只读，且应尽快释放（持有过多会占住解码器缓冲池）。
+struct YuvFrame {
+    enum Format { I420, NV12 };
+    Format format = I420;
+    int    width  = 0;
+    int    height = 0;
+    int    planes = 0;
+    const uchar* data[3] = { nullptr, nullptr, nullptr };
+    int    stride[3]     = { 0, 0, 0 };
+    FrameMeta meta;
 };
 
 Q_DECLARE_METATYPE(myRecordOptions)
+Q_DECLARE_METATYPE(FrameMeta)
+Q_DECLARE_METATYPE(QSharedPointer<EncodedPacket>)
+Q_DECLARE_METATYPE(QVector<QSharedPointer<EncodedPacket>>)
+Q_DECLARE_METATYPE(QSharedPointer<YuvFrame>)
 
 
 
@@ -0,0 +1,147 @@
+#include "overlaystripcache.h"
+
+#include <QDateTime>
+#include <QFont>
+#include <QFontMetrics>
+#include <QPainter>
+#include <cmath>
+#include <cstring>
+
+static constexpr int kTopMargin = 6;
+
+const QImage& OverlayStripCache::strip(qint64 stampUtcUs, const QString& topText, double scale,
+                                       QImage::Format fmt)
+{
+    const qint64 utcUs = stampUtcUs > 0 ? stampUtcUs : QDateTime::currentMSecsSinceEpoch() * 1000;
+    const qint64 sec = utcUs / 1000000;
+    if (sec != sec_ || fmt != fmt_ || topText != text_ || std::fabs(scale - scale_) > 1e-3)
+        render(sec, topText, scale, fmt);
+    return strip_;
+}
+
+void OverlayStripCache::render(qint64 sec, const QString& topText, double scale, QImage::Format fmt)
+{
+    sec_ = sec;
+    text_ = topText;
+    scale_ = scale;
+    fmt_ = fmt;
+    ++renders_;
+
+    QFont font("Arial", 20, QFont::Bold);
+    if (scale > 0.0 && scale < 1.0) font.setPointSizeF(20 * scale);
+    const QFontMetrics fm(font);
+    const int pad = qMax(2, (int)std::lround(6 * qMin(scale, 1.0)));
+    const QString line = QDateTime::fromMSecsSinceEpoch(sec * 1000).toString("yyyy-MM-dd HH:mm:ss")
+                       + (topText.isEmpty() ? "" : "  " + topText);
+
+    // 在可绘制的格式上画，再一次性转成帧格式（每秒一次）
+    QImage img(fm.horizontalAdvance(line) + pad * 2, fm.height() + pad * 2, QImage::Format_ARGB32_Premultiplied);
+    img.fill(Qt::black);
+    {
+        QPainter p(&img);
+        p.setRenderHint(QPainter::TextAntialiasing);
+        p.setFont(font);
+        p.setPen(Qt::white);
+        p.drawText(img.rect(), Qt::AlignCenter, line);
+    }
+    strip_ = (fmt == img.format()) ? img : img.convertToFormat(fmt);
+}
+
+QRect OverlayStripCache::placement(const QSize& frameSize) const
+{
+    const QRect r(QPoint((frameSize.width() - strip_.width()) / 2, kTopMargin), strip_.size());
+    return r.intersected(QRect(QPoint(0, 0), frameSize));
+}
+
+void OverlayStripCache::blendInto(QImage& dst, qint64 stampUtcUs, const QString& topText, double scale)
+{
+    if (dst.isNull() || dst.depth() % 8 != 0) return;
+    const QImage& s = strip(stampUtcUs, topText, scale, dst.format());
+    if (s.isNull()) return;
+
+    const QRect r = placement(dst.size());
+    if (r.isEmpty()) return;
+
+    const int bpp = dst.depth() / 8;
+    const int sx = r.x() - (dst.width() - s.width()) / 2;   // 帧比横幅窄时左右裁掉
+    const int sy = r.y() - kTopMargin;
+    const size_t rowBytes = (size_t)r.width() * bpp;
+    for (int y = 0; y < r.height(); ++y) {
+        std::memcpy(dst.scanLine(r.y() + y) + (size_t)r.x() * bpp,
+                    s.constScanLine(sy + y) + (size_t)sx * bpp,
+                    rowBytes);
+    }
+}
+
+// 每次重绘后一次：ARGB 横幅 → Y 全分辨率 + U/V 2x2 平均
+void OverlayStripCache::convertToYuv()
+{
+    yuvRender_ = renders_;
+    const int w = strip_.width(), h = strip_.height();
+    yuvW_ = (w + 1) & ~1;
+    yuvH_ = (h + 1) & ~1;
+    const int cw = yuvW_ / 2, ch = yuvH_ / 2;
+    yuvY_.fill(char(16), yuvW_ * yuvH_);
+    yuvU_.fill(char(128), cw * ch);
+    yuvV_.fill(char(128), cw * ch);
+
+    auto rgbAt = [&](int x, int y, int& r, int& g, int& b) {
+        if (x >= w || y >= h) { r = g = b = 0; return; }   // 补边：黑
+        const QRgb p = reinterpret_cast<const QRgb*>(strip_.constScanLine(y))[x];
+        r = qRed(p); g = qGreen(p); b = qBlue(p);
+    };
+    uchar* Y = reinterpret_cast<uchar*>(yuvY_.data());
+    uchar* U = reinterpret_cast<uchar*>(yuvU_.data());
+    uchar* V = reinterpret_cast<uchar*>(yuvV_.data());
+    for (int cy = 0; cy < ch; ++cy) {
+        for (int cx = 0; cx < cw; ++cx) {
+            int rs = 0, gs = 0, bs = 0;
+            for (int k = 0; k < 4; ++k) {
+                const int x = cx * 2 + (k & 1), y = cy * 2 + (k >> 1);
+                int r, g, b;
+                rgbAt(x, y, r, g, b);
+                Y[y * yuvW_ + x] = uchar(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+                rs += r; gs += g; bs += b;
+            }
+            rs /= 4; gs /= 4; bs /= 4;
+            U[cy * cw + cx] = uchar(((-38 * rs - 74 * gs + 112 * bs + 128) >> 8) + 128);
+            V[cy * cw + cx] = uchar(((112 * rs - 94 * gs - 18 * bs + 128) >> 8) + 128);
+        }
+    }
+}
+
+void OverlayStripCache::blendIntoYuv420(uchar* const planes[3], const int strides[3], int width, int height,
+                                        bool nv12, qint64 stampUtcUs, const QString& topText)
+{
+    if (width < 2 || height < 2) return;
+    if (strip(stampUtcUs, topText, 1.0, QImage::Format_ARGB32).isNull()) return;
+    if (yuvRender_ != renders_ || yuvW_ == 0) convertToYuv();
+
+    // 与 blendInto 同样水平居中、距顶 kTopMargin；色度 2x2 采样，起点取偶数
+    int x0 = ((width - yuvW_) / 2) & ~1;
+    int sx = 0;
+    if (x0 < 0) { sx = (-x0 + 1) & ~1; x0 = 0; }
+    const int y0 = kTopMargin & ~1;
+    const int cw = qMin(yuvW_ - sx, width - x0) & ~1;
+    const int chh = qMin(yuvH_, height - y0) & ~1;
+    if (cw <= 0 || chh <= 0) return;
+
+    const uchar* Y = reinterpret_cast<const uchar*>(yuvY_.constData());
+    for (int y = 0; y < chh; ++y)
+        std::memcpy(planes[0] + (size_t)(y0 + y) * strides[0] + x0, Y + (size_t)y * yuvW_ + sx, cw);
+
+    const int sw2 = yuvW_ / 2;
+    const uchar* U = reinterpret_cast<const uchar*>(yuvU_.constData());
+    const uchar* V = reinterpret_cast<const uchar*>(yuvV_.constData());
+    for (int y = 0; y < chh / 2; ++y) {
+        const uchar* su = U + (size_t)y * sw2 + sx / 2;
+        const uchar* sv = V + (size_t)y * sw2 + sx / 2;
+        if (nv12) {
+            uchar* uv = planes[1] + (size_t)(y0 / 2 + y) * strides[1] + x0;
+            for (int i = 0; i < cw / 2; ++i) { uv[2 * i] = su[i]; uv[2 * i + 1] = sv[i]; }
+        } else {
+            std::memcpy(planes[1] + (size_t)(y0 / 2 + y) * strides[1] + x0 / 2, su, cw / 2);
+            std::memcpy(planes[2] + (size_t)(y0 / 2 + y) * strides[2] + x0 / 2, sv, cw / 2);
+        }
+    }
+}
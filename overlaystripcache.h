@@ -0,0 +1,50 @@
+// overlaystripcache.h
+// 叠加横幅（"时间戳  顶部文字"，黑底白字，帧顶部居中）的预渲染缓存。
+// 横幅只在秒数、文字、缩放比例或像素格式变化时用 QPainter 重绘一次；每帧只把横幅的
+// 矩形逐行写进目标帧，代价与横幅大小成正比，与帧大小无关，也不再每帧构造 QFont/QFontMetrics。
+// 横幅完全不透明（黑底），"混合"即按行拷贝。非线程安全：每个使用线程/用途各持一个实例。
+// 录像在编码器输入（平面 YUV 4:2:0）上写横幅：横幅每次重绘后转一次 YUV，每帧同样只拷横幅矩形。
+#pragma once
+
+#include <QByteArray>
+#include <QImage>
+#include <QRect>
+#include <QString>
+#include <climits>
+
+class OverlayStripCache
+{
+public:
+    // stampUtcUs：叠加的时间（帧的采集/到达墙钟，见 FrameMeta::utcUs()），<= 0 时用当前时间
+    // scale：帧相对源分辨率的缩放（预览帧已缩放时 < 1），文字按同比例绘制
+    const QImage& strip(qint64 stampUtcUs, const QString& topText, double scale, QImage::Format fmt);
+
+    // 横幅在 frameSize 帧内的位置（水平居中，距顶 6px；超出部分裁掉）
+    QRect placement(const QSize& frameSize) const;
+
+    // 原位写入 dst（dst 须可写、字节对齐的 32/24/16 位格式）
+    void blendInto(QImage& dst, qint64 stampUtcUs, const QString& topText, double scale = 1.0);
+
+    // 原位写入平面 YUV 4:2:0 帧（BT.601 limited；横幅只有黑白灰，与矩阵无关）。
+    // nv12=false：planes[0..2] = Y/U/V（I420）；nv12=true：planes[0..1] = Y/UV 交错
+    void blendIntoYuv420(uchar* const planes[3], const int strides[3], int width, int height, bool nv12,
+                         qint64 stampUtcUs, const QString& topText);
+
+    quint64 renderCount() const { return renders_; }
+
+private:
+    void render(qint64 sec, const QString& topText, double scale, QImage::Format fmt);
+    void convertToYuv();
+
+    QImage         strip_;
+    qint64         sec_    = LLONG_MIN;
+    QString        text_;
+    double         scale_  = -1.0;
+    QImage::Format fmt_    = QImage::Format_Invalid;
+    quint64        renders_ = 0;
+
+    // strip_ 的 YUV 4:2:0 副本（宽高补齐到偶数，补边为黑）；yuvRender_ 为转换时的 renders_
+    QByteArray     yuvY_, yuvU_, yuvV_;
+    int            yuvW_ = 0, yuvH_ = 0;
+    quint64        yuvRender_ = 0;
+};
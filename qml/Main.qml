@@ -1,6 +1,7 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
+import SPW.Video 1.0
 
 Rectangle {
     id: root
@@ -129,7 +130,7 @@ Rectangle {
                 Layout.fillHeight: true
             }
 
-            // 中央视频区（ZoomPanImageView 由 C++ 嵌入此处）
+            // 中央视频区：VideoSurface 与 HUD 在同一场景图里合成
             Rectangle {
                 id: videoArea
                 Layout.fillWidth: true
@@ -139,6 +140,12 @@ Rectangle {
                 border.width: 1
                 objectName: "videoArea"
 
+                VideoSurface {
+                    objectName: "videoSurface"
+                    anchors.fill: parent
+                    anchors.margins: parent.border.width
+                }
+
                 Text {
                     anchors.centerIn: parent
                     text: qsTr("视频显示区")
@@ -171,6 +178,12 @@ Rectangle {
 
                     StatusItem { label: qsTr("分辨率"); value: uiCtrl ? uiCtrl.resolution : "1920x1080" }
                     StatusItem { label: qsTr("帧率");   value: uiCtrl ? (uiCtrl.currentFps + " fps") : "0 fps" }
+                    StatusItem { label: qsTr("网络丢包"); value: uiCtrl ? (uiCtrl.rtpNetLostPerSec.toFixed(1) + " /s") : "0.0 /s" }
+                    StatusItem { label: qsTr("缓冲丢包"); value: uiCtrl ? (uiCtrl.rtpLostPerSec.toFixed(1) + " /s") : "0.0 /s" }
+                    StatusItem { label: qsTr("迟到");   value: uiCtrl ? (uiCtrl.rtpLatePerSec.toFixed(1) + " /s") : "0.0 /s" }
+                    StatusItem { label: qsTr("重复包"); value: uiCtrl ? (uiCtrl.rtpDupPerSec.toFixed(1) + " /s") : "0.0 /s" }
+                    StatusItem { label: qsTr("网络抖动"); value: uiCtrl ? (uiCtrl.rtpJitterMs.toFixed(1) + " ms") : "0.0 ms" }
+                    StatusItem { label: qsTr("帧池丢帧"); value: uiCtrl ? uiCtrl.framePoolDrops.toFixed(0) : "0" }
 
                     Rectangle { Layout.fillWidth: true; height: 1; color: "#00cc88"; opacity: 0.2 }
 
@@ -4,7 +4,7 @@ import QtQuick.Layouts 1.15
 Rectangle {
     id: root
     width: 480
-    height: 460
+    height: 494
     color: "#020806"
     border.color: "#00cc88"
     border.width: 1
@@ -145,6 +145,21 @@ Rectangle {
                 Text { text: qsTr("录像/截图时保存叠加时间信息"); color: "#9aa0a6"; font.pixelSize: 11; font.family: "Microsoft YaHei UI" }
             }
 
+            // 直通录像（不重编码）
+            RowLayout {
+                Layout.fillWidth: true
+                Text { text: qsTr("直通录像"); color: "#9aa0a6"; font.pixelSize: 12; font.family: "Microsoft YaHei UI"; width: 100 }
+                Rectangle {
+                    width: 26; height: 26; radius: 2
+                    color: (settingsCtrl && settingsCtrl.recordPassthrough) ? "#0d2a1e" : "transparent"
+                    border.color: (settingsCtrl && settingsCtrl.recordPassthrough) ? "#00ff99" : "#00cc88"
+                    border.width: 1
+                    Text { anchors.centerIn: parent; text: "✓"; color: "#00ff99"; font.pixelSize: 14; visible: settingsCtrl && settingsCtrl.recordPassthrough }
+                    MouseArea { anchors.fill: parent; onClicked: if (settingsCtrl) settingsCtrl.recordPassthrough = !settingsCtrl.recordPassthrough }
+                }
+                Text { text: qsTr("保存相机原始码流（叠加信息写入文件元数据）"); color: "#9aa0a6"; font.pixelSize: 11; font.family: "Microsoft YaHei UI" }
+            }
+
             // 语言切换
             RowLayout {
                 Layout.fillWidth: true
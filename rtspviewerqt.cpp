@@ -1,25 +1,36 @@
 // rtspviewerqt.cpp  (FULL REPLACEABLE FILE)
-// Windows/Qt + GStreamer RTSP client (UDP) + sample-interval jitter stats.
+// Windows/Qt + GStreamer RTSP client (UDP) + sample-interval jitter stats
+// (log-bucketed histograms, always on; see streamStats()).
 //
 // Stability upgrades WITHOUT lowering latency:
-// - Force rtspsrc pad selection via "rtspsrc name=src ... src. !" to avoid linking to wrong pad (NO VIDEO bug).
+// - rtspsrc video pad is linked by our own pad-added handler to the named post-src queue (srcq),
+//   only for media=video pads (avoids linking to the wrong pad: NO VIDEO bug), and re-links on every new session.
 // - Add isolation queue after rtspsrc.
 // - appsink max-buffers=2 (drop=true) to tolerate short copy/UI jitter.
 // - pullTimeout 40ms reduces busy polling jitter (does not add media latency).
 // - nominalGap derived from negotiated caps framerate.
+// - H264/H265: depay/parse/decoder chain chosen from the SDP encoding-name (ranked decoder table per codec).
+// - optional zero-copy: QImage wraps the mapped GstBuffer (no per-frame memcpy).
+// - IDR gate on the parse output: nothing reaches the decoder before the first keyframe (no green frames,
+//   no fixed warmup skip); upstream force-key-unit (RTCP PLI/FIR) on open, reconnect and RTP loss.
 //
-// Reconnect on ERROR/EOS or prolonged no-sample.
+// Reconnect on ERROR/EOS or prolonged no-sample:
+//   1) warm: restart only rtspsrc (NULL -> flush downstream -> sync with parent), decoder/appsink stay alive;
+//   2) full: rebuild the pipeline, with jittered exponential backoff between attempts.
 
 #include "rtspviewerqt.h"
+#include "ingestpipeline.h"
+#include "latencycontroller.h"
 
 #include <QElapsedTimer>
+#include <QRandomGenerator>
 #include <QThread>
 #include <algorithm>
-#include <functional>
+#include <atomic>
 #include <mutex>
-#include <array>
-#include <vector>
 #include <cmath>
+#include <cstring>
+#include <chrono>
 
 extern "C" {
 #include <gst/gst.h>
@@ -46,145 +57,85 @@ static QString capsToString(GstCaps* caps)
     return out;
 }
 
-static bool hasFactory(const char* name)
+// 总线同步处理：消息在投递线程（流线程 / rtspsrc 任务线程）里就地处理后 DROP，不进总线队列，
+// 拉流循环不再轮询总线。ERROR/EOS 只置原子标志并记下投递时刻，循环每轮读一次标志，
+// 最迟一个 pullTimeout（40ms）内响应。日志仅限低频消息，logLine 跨线程排队投递。
+struct BusWatch {
+    RtspViewerQt* viewer = nullptr;
+    GstElement*   pipeline = nullptr;
+    std::atomic<bool>   fault{false};      // 收到 ERROR 或 EOS
+    std::atomic<qint64> faultAtUs{0};      // 首个 ERROR/EOS 的投递时刻（monotonicUs）
+
+    void reset()
+    {
+        faultAtUs.store(0, std::memory_order_relaxed);
+        fault.store(false, std::memory_order_release);
+    }
+};
+
+static void bus_watch_fault(BusWatch* w)
 {
-    GstElementFactory* f = gst_element_factory_find(name);
-    if (f) { gst_object_unref(f); return true; }
-    return false;
+    qint64 expected = 0;
+    w->faultAtUs.compare_exchange_strong(expected, RtspViewerQt::monotonicUs(), std::memory_order_relaxed);
+    w->fault.store(true, std::memory_order_release);
 }
 
-static void pump_bus(GstElement* pipeline,
-                     const std::function<void(const QString&)>& logFn,
-                     bool* needReconnect)
+static GstBusSyncReply bus_sync_handler(GstBus*, GstMessage* msg, gpointer data)
 {
-    GstBus* bus = gst_element_get_bus(pipeline);
-    while (gst_bus_have_pending(bus)) {
-        GstMessage* msg = gst_bus_pop(bus);
-        if (!msg) break;
-
-        switch (GST_MESSAGE_TYPE(msg)) {
-        case GST_MESSAGE_ERROR: {
-            GError* err = nullptr;
-            gchar* dbg = nullptr;
-            gst_message_parse_error(msg, &err, &dbg);
-            logFn(QString("[GST][ERR] %1 | %2")
-                      .arg(qstr(err ? err->message : ""))
-                      .arg(qstr(dbg)));
-            if (err) g_error_free(err);
-            if (dbg) g_free(dbg);
-            if (needReconnect) *needReconnect = true;
-        } break;
-        case GST_MESSAGE_EOS: {
-            logFn("[GST][EOS] end of stream");
-            if (needReconnect) *needReconnect = true;
-        } break;
-        case GST_MESSAGE_WARNING: {
-            GError* err = nullptr;
-            gchar* dbg = nullptr;
-            gst_message_parse_warning(msg, &err, &dbg);
-            logFn(QString("[GST][WRN] %1 | %2")
-                      .arg(qstr(err ? err->message : ""))
-                      .arg(qstr(dbg)));
-            if (err) g_error_free(err);
-            if (dbg) g_free(dbg);
-        } break;
-        case GST_MESSAGE_STATE_CHANGED: {
-            if (GST_MESSAGE_SRC(msg) == GST_OBJECT(pipeline)) {
-                GstState oldS, newS, pend;
-                gst_message_parse_state_changed(msg, &oldS, &newS, &pend);
-                logFn(QString("[GST] state: %1 -> %2")
-                          .arg(gst_element_state_get_name(oldS))
-                          .arg(gst_element_state_get_name(newS)));
-            }
-        } break;
-        default:
-            break;
+    auto* w = static_cast<BusWatch*>(data);
+
+    switch (GST_MESSAGE_TYPE(msg)) {
+    case GST_MESSAGE_ERROR: {
+        bus_watch_fault(w);
+        GError* err = nullptr;
+        gchar* dbg = nullptr;
+        gst_message_parse_error(msg, &err, &dbg);
+        emit w->viewer->logLine(QString("[GST][ERR] %1 | %2")
+                                    .arg(qstr(err ? err->message : ""))
+                                    .arg(qstr(dbg)));
+        if (err) g_error_free(err);
+        if (dbg) g_free(dbg);
+    } break;
+    case GST_MESSAGE_EOS: {
+        bus_watch_fault(w);
+        emit w->viewer->logLine("[GST][EOS] end of stream");
+    } break;
+    case GST_MESSAGE_WARNING: {
+        GError* err = nullptr;
+        gchar* dbg = nullptr;
+        gst_message_parse_warning(msg, &err, &dbg);
+        emit w->viewer->logLine(QString("[GST][WRN] %1 | %2")
+                                    .arg(qstr(err ? err->message : ""))
+                                    .arg(qstr(dbg)));
+        if (err) g_error_free(err);
+        if (dbg) g_free(dbg);
+    } break;
+    case GST_MESSAGE_STATE_CHANGED: {
+        if (GST_MESSAGE_SRC(msg) == GST_OBJECT(w->pipeline)) {
+            GstState oldS, newS, pend;
+            gst_message_parse_state_changed(msg, &oldS, &newS, &pend);
+            emit w->viewer->logLine(QString("[GST] state: %1 -> %2")
+                                        .arg(gst_element_state_get_name(oldS))
+                                        .arg(gst_element_state_get_name(newS)));
         }
-
-        gst_message_unref(msg);
+    } break;
+    default:
+        break;
     }
-    gst_object_unref(bus);
+    return GST_BUS_DROP;
 }
 
-// -------------------------- Pipeline Builders (UDP) --------------------------
-static constexpr int  kUdpRcvBufBytes = 16 * 1024 * 1024; // 16MB
-// drop-on-latency 作用于 rtspjitterbuffer（RTP 域，按整帧丢弃，解码安全）
-// 用于抑制长时延迟累积；如仍怀疑启动异常可临时置 false 回退。
-static constexpr bool kDropOnLatency  = true;
-
-// 压缩域队列：绝不能 leaky（丢压缩帧会破坏 H264 参考链 → 绿屏/花屏）。
-// leaky=no + 时间上限，满时对上游产生背压由 jitterbuffer 的 drop-on-latency 兜底。
-static const char* kPostSrcQueue =
-    "queue max-size-time=200000000 max-size-buffers=0 max-size-bytes=0 leaky=no";
-
-// Pre-decode queue（同为压缩域，leaky=no）
-static const char* kPreDecodeQueue =
-    "queue max-size-time=200000000 max-size-buffers=0 max-size-bytes=0 min-threshold-time=0 leaky=no";
-
-static QString build_hw_d3d11_pipeline_udp(const QString& url, int latencyMs)
-{
-    return QString(
-               "rtspsrc name=src location=%1 protocols=udp latency=%2 buffer-mode=auto "
-               "udp-buffer-size=%3 do-retransmission=false drop-on-latency=%4 timeout=5000000 "
-               "src. ! %5 "
-               "! rtph264depay "
-               "! h264parse "
-               "! %6 "
-               "! d3d11h264dec "
-               "! d3d11convert "
-               "! video/x-raw(memory:D3D11Memory),format=BGRA "
-               "! d3d11download "
-               "! video/x-raw,format=BGRA "
-               "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
-               "! appsink name=sink drop=true max-buffers=2 sync=false"
-               ).arg(url)
-        .arg(latencyMs)
-        .arg(kUdpRcvBufBytes)
-        .arg(kDropOnLatency ? "true" : "false")
-        .arg(kPostSrcQueue)
-        .arg(kPreDecodeQueue);
-}
-
-static QString build_sw_pipeline_udp(const QString& url, int latencyMs)
-{
-    return QString(
-               "rtspsrc name=src location=%1 protocols=udp latency=%2 buffer-mode=auto "
-               "udp-buffer-size=%3 do-retransmission=false drop-on-latency=%4 timeout=5000000 "
-               "src. ! %5 "
-               "! rtph264depay "
-               "! h264parse "
-               "! %6 "
-               "! avdec_h264 "
-               "! videoconvert "
-               "! video/x-raw,format=BGRA "
-               "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
-               "! appsink name=sink drop=true max-buffers=2 sync=false"
-               ).arg(url)
-        .arg(latencyMs)
-        .arg(kUdpRcvBufBytes)
-        .arg(kDropOnLatency ? "true" : "false")
-        .arg(kPostSrcQueue)
-        .arg(kPreDecodeQueue);
-}
-
-static QString build_fallback_decodebin_udp(const QString& url, int latencyMs)
-{
-    return QString(
-               "rtspsrc name=src location=%1 protocols=udp latency=%2 buffer-mode=auto "
-               "udp-buffer-size=%3 do-retransmission=false drop-on-latency=%4 timeout=5000000 "
-               "src. ! %5 "
-               "! decodebin "
-               "! videoconvert "
-               "! video/x-raw,format=BGRA "
-               "! queue leaky=downstream max-size-buffers=2 max-size-time=0 max-size-bytes=0 "
-               "! appsink name=sink drop=true max-buffers=2 sync=false"
-               ).arg(url)
-        .arg(latencyMs)
-        .arg(kUdpRcvBufBytes)
-        .arg(kDropOnLatency ? "true" : "false")
-        .arg(kPostSrcQueue);
+static void install_bus_watch(GstElement* pipeline, BusWatch* w)
+{
+    GstBus* bus = gst_element_get_bus(pipeline);
+    gst_bus_set_sync_handler(bus, w ? bus_sync_handler : nullptr, w, nullptr);
+    gst_object_unref(bus);
 }
 
+// latency 取值范围：直连相机可到 150ms，噪声链路最高 600ms（由 LatencyController 自适应）
+static constexpr int kMinLatencyMs = 150;
+static constexpr int kMaxLatencyMs = 600;
+
 static bool wait_playing_or_fail(GstElement* pipeline, int timeout_ms, QString& errOut)
 {
     GstState state = GST_STATE_NULL, pending = GST_STATE_NULL;
@@ -203,22 +154,185 @@ static bool wait_playing_or_fail(GstElement* pipeline, int timeout_ms, QString&
     return true;
 }
 
+// --------- source (re)link / warm restart ----------
+// rtspsrc 每次建立会话都会新建 src pad；接到 srcq（未连接时）。srcq 不存在返回 NOFORMAT 以外的错误码
+static GstPadLinkReturn link_to_srcq(GstElement* src, GstPad* pad)
+{
+    GstObject* parent = gst_object_get_parent(GST_OBJECT(src));
+    if (!parent) return GST_PAD_LINK_WRONG_HIERARCHY;
+    GstElement* q = gst_bin_get_by_name(GST_BIN(parent), "srcq");
+    gst_object_unref(parent);
+    if (!q) return GST_PAD_LINK_WRONG_HIERARCHY;
+
+    GstPadLinkReturn r = GST_PAD_LINK_OK;
+    GstPad* sink = gst_element_get_static_pad(q, "sink");
+    if (sink && !gst_pad_is_linked(sink)) r = gst_pad_link(pad, sink);
+    if (sink) gst_object_unref(sink);
+    gst_object_unref(q);
+    return r;
+}
+
+// 只重启 rtspsrc：旧会话 pad 随 NULL 移除；冲刷下游（清 EOS/旧 segment），清掉旧会话的 ERROR/EOS 标志，
+// 再随父 bin 回到 PLAYING。解码器/转换/appsink 不动。
+static bool restart_source(GstElement* pipeline, GstElement* src, const QString& url, BusWatch* busWatch)
+{
+    gst_element_set_state(src, GST_STATE_NULL);
+
+    GstElement* q = gst_bin_get_by_name(GST_BIN(pipeline), "srcq");
+    if (!q) return false;
+    if (GstPad* sink = gst_element_get_static_pad(q, "sink")) {
+        gst_pad_send_event(sink, gst_event_new_flush_start());
+        gst_pad_send_event(sink, gst_event_new_flush_stop(FALSE));
+        gst_object_unref(sink);
+    }
+    gst_object_unref(q);
+
+    // 旧会话的消息已在 NULL 之前同步投递完，此后的 ERROR/EOS 属于新会话
+    busWatch->reset();
+
+    g_object_set(src, "location", url.toUtf8().constData(), NULL);
+    return gst_element_sync_state_with_parent(src) != FALSE;
+}
+
+// rtpjitterbuffer 累计计数（rtspsrc 内部每路流一个，求和）
+struct JitterBufferStats {
+    quint64 pushed = 0;
+    quint64 lost = 0;
+    quint64 late = 0;
+    quint64 duplicates = 0;
+    double  avgJitterMs = 0.0;    // 各路最大值
+    int     count = 0;
+};
+
+static JitterBufferStats read_jitterbuffer_stats(GstElement* src)
+{
+    JitterBufferStats out;
+    GstIterator* it = gst_bin_iterate_recurse(GST_BIN(src));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+        GstElement* e = GST_ELEMENT(g_value_get_object(&item));
+        GstElementFactory* f = gst_element_get_factory(e);
+        if (f && g_str_equal(GST_OBJECT_NAME(f), "rtpjitterbuffer")) {
+            GstStructure* st = nullptr;
+            g_object_get(e, "stats", &st, NULL);
+            if (st) {
+                guint64 v = 0;
+                if (gst_structure_get_uint64(st, "num-pushed", &v)) out.pushed += v;
+                if (gst_structure_get_uint64(st, "num-lost", &v))   out.lost += v;
+                if (gst_structure_get_uint64(st, "num-late", &v))   out.late += v;
+                if (gst_structure_get_uint64(st, "num-duplicates", &v)) out.duplicates += v;
+                if (gst_structure_get_uint64(st, "avg-jitter", &v))
+                    out.avgJitterMs = std::max(out.avgJitterMs, v / 1e6);
+                gst_structure_free(st);
+                ++out.count;
+            }
+        }
+        g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+    return out;
+}
+
+// rtpsession 统计（rtspsrc 内 rtpbin "manager" 的会话 0 = 视频）：
+//   packetsLost —— 发送端源按 RFC 3550 由序号推算的累计丢包（jitterbuffer 之前，即纯网络丢包；重复包可使其为负）
+// 不取 RTT：只收不发的客户端没有 RTP 流可让相机在报告块里回报，rb-round-trip 永远没有值
+struct RtpSessionStats {
+    qint64 packetsLost = 0;
+    bool   valid = false;
+};
+
+static RtpSessionStats read_rtpsession_stats(GstElement* src)
+{
+    RtpSessionStats out;
+    GstElement* mgr = gst_bin_get_by_name(GST_BIN(src), "manager");
+    if (!mgr) return out;
+    GstElement* session = nullptr;
+    g_signal_emit_by_name(mgr, "get-session", 0u, &session);
+    gst_object_unref(mgr);
+    if (!session) return out;
+
+    GstStructure* st = nullptr;
+    g_object_get(session, "stats", &st, NULL);
+    gst_object_unref(session);
+    if (!st) return out;
+
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS   // source-stats 是 GValueArray
+    const GValue* arr = gst_structure_get_value(st, "source-stats");
+    GValueArray* sources = (arr && G_VALUE_HOLDS(arr, G_TYPE_VALUE_ARRAY))
+                               ? static_cast<GValueArray*>(g_value_get_boxed(arr)) : nullptr;
+    for (guint i = 0; sources && i < sources->n_values; ++i) {
+        const GstStructure* ss = gst_value_get_structure(g_value_array_get_nth(sources, i));
+        gboolean internal = FALSE, isSender = FALSE;
+        if (!ss || (gst_structure_get_boolean(ss, "internal", &internal) && internal)) continue;
+        if (gst_structure_get_boolean(ss, "is-sender", &isSender) && isSender) {
+            gint lost = 0;
+            if (gst_structure_get_int(ss, "packets-lost", &lost)) out.packetsLost += lost;
+            out.valid = true;
+        }
+    }
+    G_GNUC_END_IGNORE_DEPRECATIONS
+    gst_structure_free(st);
+    return out;
+}
+
+// 运行中修改：rtpbin(manager) 会把 latency/drop-on-latency 下发给所有 jitterbuffer；
+// rtspsrc 上的同名属性用于之后新建的会话（热重启）
+static void apply_jitterbuffer_props(GstElement* src, int latencyMs, bool dropOnLatency)
+{
+    g_object_set(src, "latency", (guint)latencyMs, "drop-on-latency", (gboolean)dropOnLatency, NULL);
+    if (GstElement* mgr = gst_bin_get_by_name(GST_BIN(src), "manager")) {
+        g_object_set(mgr, "latency", (guint)latencyMs, "drop-on-latency", (gboolean)dropOnLatency, NULL);
+        gst_object_unref(mgr);
+    }
+}
+
+// 全量重建前的等待：200ms 起指数退避到 5s，±25% 抖动（避免多路同时重连形成同步风暴）；可被 stop() 打断
+static void sleep_backoff(int failures, const std::atomic<bool>& stopFlag, const QThread* th)
+{
+    const int exp = std::min(failures, 5);
+    const int baseMs = std::min(5000, 200 << exp);
+    const int ms = (int)(baseMs * (0.75 + 0.5 * QRandomGenerator::global()->generateDouble()));
+    QElapsedTimer t; t.start();
+    while (t.elapsed() < ms) {
+        if (stopFlag.load(std::memory_order_acquire) || th->isInterruptionRequested()) return;
+        QThread::msleep(20);
+    }
+}
+
 // --------- jitter helpers ----------
-static inline double clampd(double v, double lo, double hi){
-    return std::max(lo, std::min(hi, v));
+// 样本在 appsink 被取出时相对其 PTS（running time）的滞后（us）；无法计算返回 -1
+static qint64 sample_age_us(GstElement* pipeline, GstSample* sample)
+{
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    const GstSegment* seg = gst_sample_get_segment(sample);
+    if (!buf || !seg || !GST_BUFFER_PTS_IS_VALID(buf)) return -1;
+
+    GstClock* clock = gst_element_get_clock(pipeline);
+    if (!clock) return -1;
+    const GstClockTime now = gst_clock_get_time(clock);
+    gst_object_unref(clock);
+
+    const GstClockTime base = gst_element_get_base_time(pipeline);
+    const guint64 rt = gst_segment_to_running_time(seg, GST_FORMAT_TIME, GST_BUFFER_PTS(buf));
+    if (rt == GST_CLOCK_TIME_NONE || now < base) return -1;
+
+    const GstClockTimeDiff age = GST_CLOCK_DIFF(rt, now - base);
+    return age > 0 ? (qint64)(age / GST_USECOND) : 0;
 }
 
-static double percentile_ms(std::vector<double>& v, double p01)
+// NTP 纪元（1900-01-01）与 Unix 纪元相差 2208988800 s
+static constexpr qint64 kNtpToUnixUs = 2208988800LL * 1000 * 1000;
+
+// 发送端采集时刻（Unix 纪元 UTC，us），来自 SR 映射的 reference timestamp meta；无则 -1
+static qint64 capture_utc_us(GstBuffer* buf)
 {
-    if (v.empty()) return 0.0;
-    std::sort(v.begin(), v.end());
-    const double p = clampd(p01, 0.0, 1.0);
-    const double idx = p * (double)(v.size() - 1);
-    const size_t i0 = (size_t)std::floor(idx);
-    const size_t i1 = (size_t)std::ceil(idx);
-    if (i0 == i1) return v[i0];
-    const double t = idx - (double)i0;
-    return v[i0] * (1.0 - t) + v[i1] * t;
+    if (!buf) return -1;
+    static GstCaps* ntpCaps = gst_caps_new_empty_simple("timestamp/x-ntp");
+    GstReferenceTimestampMeta* m = gst_buffer_get_reference_timestamp_meta(buf, ntpCaps);
+    if (!m || m->timestamp == GST_CLOCK_TIME_NONE) return -1;
+    const qint64 us = (qint64)(m->timestamp / GST_USECOND) - kNtpToUnixUs;
+    return us > 0 ? us : -1;
 }
 
 static double caps_fps(const GstCaps* caps, double fallbackFps)
@@ -234,6 +348,30 @@ static double caps_fps(const GstCaps* caps, double fallbackFps)
     return fallbackFps;
 }
 
+// --------- zero-copy wrap ----------
+// 零拷贝模式下 QImage 直接引用 appsink 的映射内存；
+// 最后一个 QImage 副本析构时由 Qt 回调 release_mapped_sample 解除映射并释放 sample。
+struct MappedSample {
+    GstSample* sample = nullptr;
+    GstBuffer* buffer = nullptr;
+    GstMapInfo map;
+};
+
+// 平面 YUV 帧：按 GstVideoInfo 映射（各平面偏移/跨距由 GstVideoMeta 给出），随 YuvFrame 释放
+struct MappedVideoFrame {
+    GstSample*     sample = nullptr;
+    GstVideoFrame  frame;
+};
+
+static void release_mapped_sample(void* info)
+{
+    auto* m = static_cast<MappedSample*>(info);
+    if (!m) return;
+    if (m->buffer) gst_buffer_unmap(m->buffer, &m->map);
+    if (m->sample) gst_sample_unref(m->sample);
+    delete m;
+}
+
 // ---------------------------------------------------------------------------
 
 RtspViewerQt::RtspViewerQt(QObject* parent)
@@ -253,14 +391,329 @@ void RtspViewerQt::setUrl(const QString& url)
     url_ = url;
 }
 
+// ---------------------------------------------------------------------------
+// 逐帧元数据
+
+void RtspViewerQt::resetFrameTrack()
+{
+    std::lock_guard<std::mutex> lk(trackMtx_);
+    for (FrameTrack& t : track_) t = FrameTrack{};
+    trackHead_ = 0;
+    lastRtpSeq_ = -1;
+    rtpSeen_.store(false, std::memory_order_release);
+    rtpLossSeen_.store(false, std::memory_order_release);
+}
+
+// srcq 入口（rtspsrc 流线程）：RTP 包已过 jitterbuffer。RTP 时间戳变化即新的一帧，
+// 同帧后续包只更新序号与 PTS（depay 输出的 AU 带最后一个包的 PTS）
+void RtspViewerQt::onRtpPacket(_GstBuffer* buf)
+{
+    if (!GST_BUFFER_PTS_IS_VALID(buf)) return;
+    guint8 hdr[8];
+    if (gst_buffer_extract(buf, 0, hdr, sizeof(hdr)) != sizeof(hdr) || (hdr[0] >> 6) != 2) return;
+    const int seq = (hdr[2] << 8) | hdr[3];
+    const quint32 ts = ((quint32)hdr[4] << 24) | ((quint32)hdr[5] << 16) | ((quint32)hdr[6] << 8) | hdr[7];
+
+    std::lock_guard<std::mutex> lk(trackMtx_);
+    if (lastRtpSeq_ >= 0 && seq != ((lastRtpSeq_ + 1) & 0xffff))
+        rtpLossSeen_.store(true, std::memory_order_release);
+    lastRtpSeq_ = seq;
+    rtpSeen_.store(true, std::memory_order_release);
+
+    FrameTrack* t = &track_[trackHead_];
+    if (t->rtpSeq < 0 || t->rtpTs != ts) {
+        trackHead_ = (trackHead_ + 1) % kFrameTrackSlots;
+        t = &track_[trackHead_];
+        t->rtpTs = ts;
+        t->arrivalUs = monotonicUs();
+        t->arrivalUtcUs = wallClockUtcUs();
+        t->decodeDoneUs = 0;
+    }
+    t->ptsNs = (qint64)GST_BUFFER_PTS(buf);
+    t->rtpSeq = seq;
+}
+
+// ---------------------------------------------------------------------------
+// IDR 闸门与关键帧请求
+
+void RtspViewerQt::armIdrGate()
+{
+    idrGateDropped_.store(0, std::memory_order_relaxed);
+    idrGate_.store(true, std::memory_order_release);
+}
+
+// parse 输出为整 AU（config-interval=-1 时 SPS/PPS 随 IDR 一起），非关键帧带 DELTA_UNIT
+bool RtspViewerQt::onParsedBuffer(_GstBuffer* buf)
+{
+    if (!idrGate_.load(std::memory_order_acquire)) return false;
+    if (GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) {
+        idrGateDropped_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    idrGate_.store(false, std::memory_order_release);
+    return false;
+}
+
+// 上游 GstForceKeyUnit：经 srcq → rtspsrc → rtpjitterbuffer 到 rtpsession，由其发 RTCP PLI/FIR。
+// 相机 SDP 须声明 a=rtcp-fb:* nack pli（或 ccm fir），否则 rtpsession 不会发，只能等下一个 GOP
+static bool request_key_unit(GstElement* pipeline)
+{
+    GstElement* q = gst_bin_get_by_name(GST_BIN(pipeline), "srcq");
+    if (!q) return false;
+    GstEvent* ev = gst_video_event_new_upstream_force_key_unit(GST_CLOCK_TIME_NONE, TRUE, 0);
+    const bool ok = gst_element_send_event(q, ev);
+    gst_object_unref(q);
+    return ok;
+}
+
+// 预解码队列 decq 入口（parse 输出线程）：解码关闭时丢弃；重新打开后丢到下一个 IDR
+bool RtspViewerQt::onPreDecodeBuffer(_GstBuffer* buf)
+{
+    preDecodeFrames_.fetch_add(1, std::memory_order_relaxed);
+    if (!decodeOn_.load(std::memory_order_acquire)) {
+        decodeResync_.store(true, std::memory_order_release);
+        return true;
+    }
+    if (!decodeResync_.load(std::memory_order_acquire)) return false;
+    if (GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT)) return true;
+    decodeResync_.store(false, std::memory_order_release);
+    return false;
+}
+
+// tee dt 入口（解码器输出线程）：记下解码完成时刻
+void RtspViewerQt::onDecodedBuffer(_GstBuffer* buf)
+{
+    decodedFrames_.fetch_add(1, std::memory_order_relaxed);
+    if (!GST_BUFFER_PTS_IS_VALID(buf)) return;
+    const qint64 pts = (qint64)GST_BUFFER_PTS(buf);
+    const qint64 now = monotonicUs();
+
+    std::lock_guard<std::mutex> lk(trackMtx_);
+    for (int i = 0; i < kFrameTrackSlots; ++i) {
+        FrameTrack& t = track_[(trackHead_ - i + kFrameTrackSlots) % kFrameTrackSlots];
+        if (t.ptsNs == pts) {
+            if (t.decodeDoneUs == 0) t.decodeDoneUs = now;
+            return;
+        }
+    }
+}
+
+// 各 appsink 取帧时调用：按 PTS 查回 RTP/到达/解码时刻。查不到（兜底管线无 dt、环已覆盖）
+// 的字段保持未知，decodeDoneUs 退化为交付时刻
+FrameMeta RtspViewerQt::makeFrameMeta(_GstBuffer* buf)
+{
+    FrameMeta m;
+    m.sn = sn_;
+    m.publishUs = monotonicUs();
+    if (!buf) return m;
+    m.captureUtcUs = capture_utc_us(buf);
+    if (GST_BUFFER_PTS_IS_VALID(buf)) {
+        m.ptsNs = (qint64)GST_BUFFER_PTS(buf);
+        std::lock_guard<std::mutex> lk(trackMtx_);
+        for (int i = 0; i < kFrameTrackSlots; ++i) {
+            const FrameTrack& t = track_[(trackHead_ - i + kFrameTrackSlots) % kFrameTrackSlots];
+            if (t.ptsNs == m.ptsNs) {
+                m.rtpTimestamp = t.rtpTs;
+                m.rtpSeq       = t.rtpSeq;
+                m.arrivalUs    = t.arrivalUs;
+                m.arrivalUtcUs = t.arrivalUtcUs;
+                m.decodeDoneUs = t.decodeDoneUs;
+                break;
+            }
+        }
+    }
+    if (m.decodeDoneUs == 0) m.decodeDoneUs = m.publishUs;
+    return m;
+}
+
+void RtspViewerQt::setEncodedTapEnabled(bool on)
+{
+    std::lock_guard<std::mutex> lk(tapMtx_);
+    if (on && !encodedTap_.load(std::memory_order_acquire) && preEventRing_.gopCount() > 0) {
+        const auto pre = preEventRing_.snapshot();
+        emit logLine(QString("[GST] pre-event flush: %1 AU, %2 KB, %3 ms")
+                         .arg(pre.size())
+                         .arg(preEventRing_.bytes() / 1024)
+                         .arg(preEventRing_.durationUs() / 1000));
+        emit encodedPreroll(pre);
+    }
+    encodedTap_.store(on, std::memory_order_release);
+}
+
+void RtspViewerQt::setPreEventBuffer(int seconds, qint64 maxBytes)
+{
+    std::lock_guard<std::mutex> lk(tapMtx_);
+    const bool on = seconds > 0 && maxBytes > 0;
+    preEventRing_.setLimits(on ? (qint64)seconds * 1000 * 1000 : 0, on ? maxBytes : 0);
+    preEventOn_.store(on, std::memory_order_release);
+}
+
+// esink 的 new-sample 回调（GStreamer 流线程）：拷出压缩 AU（几十 KB）后立即返回
+void RtspViewerQt::onEncodedSample(_GstAppSink* sink)
+{
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return;
+
+    if (encodedTap_.load(std::memory_order_acquire) || preEventOn_.load(std::memory_order_acquire)) {
+        GstBuffer* buf = gst_sample_get_buffer(sample);
+        GstMapInfo map;
+        if (buf && gst_buffer_map(buf, &map, GST_MAP_READ)) {
+            auto pkt = QSharedPointer<EncodedPacket>::create();
+            pkt->data = QByteArray(reinterpret_cast<const char*>(map.data), (int)map.size);
+            gst_buffer_unmap(buf, &map);
+
+            if (GST_BUFFER_PTS_IS_VALID(buf))      pkt->ptsUs = (qint64)(GST_BUFFER_PTS(buf) / GST_USECOND);
+            if (GST_BUFFER_DTS_IS_VALID(buf))      pkt->dtsUs = (qint64)(GST_BUFFER_DTS(buf) / GST_USECOND);
+            if (GST_BUFFER_DURATION_IS_VALID(buf)) pkt->durationUs = (qint64)(GST_BUFFER_DURATION(buf) / GST_USECOND);
+            pkt->keyframe = !GST_BUFFER_FLAG_IS_SET(buf, GST_BUFFER_FLAG_DELTA_UNIT);
+            pkt->captureUtcUs = capture_utc_us(buf);
+
+            if (GstCaps* caps = gst_sample_get_caps(sample)) {
+                if (GstStructure* st = gst_caps_get_structure(caps, 0)) {
+                    gst_structure_get_int(st, "width",  &pkt->width);
+                    gst_structure_get_int(st, "height", &pkt->height);
+                    if (gst_structure_has_name(st, "video/x-h265")) pkt->codec = VideoCodec::H265;
+                }
+            }
+
+            std::lock_guard<std::mutex> lk(tapMtx_);
+            if (preEventOn_.load(std::memory_order_relaxed)) preEventRing_.push(pkt);
+            if (encodedTap_.load(std::memory_order_relaxed)) emit encodedPacket(pkt);
+        }
+    }
+
+    gst_sample_unref(sample);
+}
+
+// yuvsink 的 new-sample 回调（GStreamer 流线程）：不拷贝，YuvFrame 直接引用映射后的解码缓冲
+void RtspViewerQt::onYuvSample(_GstAppSink* sink)
+{
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return;
+
+    // 录像端处理不过来时丢帧，避免大量持有解码缓冲拖住解码器
+    if (!yuvTap_.load(std::memory_order_acquire) ||
+        yuvInFlight_->load(std::memory_order_acquire) >= kMaxYuvInFlight) {
+        gst_sample_unref(sample);
+        return;
+    }
+
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstVideoInfo vinfo;
+    if (!caps || !buf || !gst_video_info_from_caps(&vinfo, caps)) {
+        gst_sample_unref(sample);
+        return;
+    }
+    const GstVideoFormat fmt = GST_VIDEO_INFO_FORMAT(&vinfo);
+    if (fmt != GST_VIDEO_FORMAT_I420 && fmt != GST_VIDEO_FORMAT_NV12) {
+        gst_sample_unref(sample);
+        return;
+    }
+
+    auto* vf = new MappedVideoFrame;
+    if (!gst_video_frame_map(&vf->frame, &vinfo, buf, GST_MAP_READ)) {
+        delete vf;
+        gst_sample_unref(sample);
+        return;
+    }
+    vf->sample = sample;
+
+    // 计数器与帧同生命周期（接收方可能在本对象析构后才释放帧）
+    std::shared_ptr<std::atomic<int>> inFlight = yuvInFlight_;
+    inFlight->fetch_add(1, std::memory_order_acq_rel);
+    QSharedPointer<YuvFrame> f(new YuvFrame, [inFlight, vf](YuvFrame* p) {
+        gst_video_frame_unmap(&vf->frame);
+        gst_sample_unref(vf->sample);
+        delete vf;
+        delete p;
+        inFlight->fetch_sub(1, std::memory_order_acq_rel);
+    });
+    f->format = fmt == GST_VIDEO_FORMAT_NV12 ? YuvFrame::NV12 : YuvFrame::I420;
+    f->width  = (int)GST_VIDEO_INFO_WIDTH(&vinfo);
+    f->height = (int)GST_VIDEO_INFO_HEIGHT(&vinfo);
+    f->planes = (int)GST_VIDEO_FRAME_N_PLANES(&vf->frame);
+    for (int i = 0; i < f->planes && i < 3; ++i) {
+        f->data[i]   = static_cast<const uchar*>(GST_VIDEO_FRAME_PLANE_DATA(&vf->frame, i));
+        f->stride[i] = GST_VIDEO_FRAME_PLANE_STRIDE(&vf->frame, i);
+    }
+    f->meta = makeFrameMeta(buf);
+
+    emit yuvFrame(f);
+}
+
+// rtspsrc pad-added（rtspsrc 流线程）：只接 media=video；SDP encoding-name 与当前解码链不符时
+// 不连接，记住该编码并通知拉流循环按正确的链重建
+void RtspViewerQt::onSourcePadAdded(_GstElement* src, _GstPad* pad)
+{
+    GstCaps* caps = gst_pad_get_current_caps(pad);
+    if (!caps) caps = gst_pad_query_caps(pad, nullptr);
+    bool video = true;
+    QString encName;
+    if (caps) {
+        const GstStructure* st = gst_caps_get_size(caps) > 0 ? gst_caps_get_structure(caps, 0) : nullptr;
+        const gchar* media = st ? gst_structure_get_string(st, "media") : nullptr;
+        video = !media || g_str_equal(media, "video");
+        if (st) encName = qstr(gst_structure_get_string(st, "encoding-name"));
+        gst_caps_unref(caps);
+    }
+    if (!video) return;
+
+    const int chain = chainCodec_.load(std::memory_order_acquire);
+    if (chain >= 0 && !encName.isEmpty()) {
+        VideoCodec c;
+        const QByteArray en = encName.toLatin1();
+        if (!codec_from_encoding_name(en.constData(), &c)) {
+            emit logLine(QString("[GST] unsupported encoding-name=%1 (H264/H265 only)").arg(encName));
+            return;
+        }
+        if ((int)c != chain) {
+            codec_.store((int)c, std::memory_order_release);
+            codecMismatch_.store(true, std::memory_order_release);
+            emit logLine(QString("[GST] SDP encoding-name=%1, chain is %2 -> rebuild")
+                             .arg(encName)
+                             .arg(codec_name((VideoCodec)chain)));
+            return;
+        }
+    }
+
+    const GstPadLinkReturn r = link_to_srcq(src, pad);
+    if (r != GST_PAD_LINK_OK) {
+        emit logLine(QString("[GST] link %1 -> srcq failed: %2")
+                         .arg(qstr(GST_PAD_NAME(pad)))
+                         .arg(qstr(gst_pad_link_get_name(r))));
+    }
+}
+
+StreamStats RtspViewerQt::streamStats() const
+{
+    std::lock_guard<std::mutex> lk(statsMtx_);
+    return stats_;
+}
+
 void RtspViewerQt::stop()
 {
     stopFlag_.store(true, std::memory_order_release);
     requestInterruption();
 }
 
-QSharedPointer<QImage> RtspViewerQt::takeLatestFrameIfNew()
+qint64 RtspViewerQt::monotonicUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+qint64 RtspViewerQt::wallClockUtcUs()
 {
+    using namespace std::chrono;
+    return duration_cast<microseconds>(system_clock::now().time_since_epoch()).count();
+}
+
+QSharedPointer<QImage> RtspViewerQt::takeLatestFrameIfNew(FrameMeta* meta)
+{
+    // 先清 pending 再读帧：之后发布的帧一定会重新发出 frameReady
+    notifyPending_.store(false, std::memory_order_release);
+
     const uint64_t cur = latestSeq_.load(std::memory_order_acquire);
     const uint64_t last = takenSeq_.load(std::memory_order_acquire);
     if (cur == 0 || cur == last) return {};
@@ -270,9 +723,71 @@ QSharedPointer<QImage> RtspViewerQt::takeLatestFrameIfNew()
     const uint64_t last2 = takenSeq_.load(std::memory_order_acquire);
     if (cur2 == 0 || cur2 == last2) return {};
     takenSeq_.store(cur2, std::memory_order_release);
+    if (meta) *meta = latestMeta_;
     return latest_;
 }
 
+QSharedPointer<QImage> RtspViewerQt::takeLatestFullFrameIfNew(FrameMeta* meta)
+{
+    fullNotifyPending_.store(false, std::memory_order_release);
+    std::lock_guard<std::mutex> lk(latestMtx_);
+    if (fullSeq_ == 0 || fullSeq_ == fullTakenSeq_) return {};
+    fullTakenSeq_ = fullSeq_;
+    if (meta) *meta = latestFullMeta_;
+    return latestFull_;
+}
+
+void RtspViewerQt::setPreviewWidth(int width)
+{
+    // 偶数宽度；与源同宽或更大等同于不缩放
+    previewWidth_.store(width > 0 ? (width + 1) & ~1 : 0, std::memory_order_release);
+}
+
+// fullsink 的 new-sample 回调（GStreamer 流线程）：零拷贝包装，只保留最新一帧
+void RtspViewerQt::onFullSample(_GstAppSink* sink)
+{
+    GstSample* sample = gst_app_sink_pull_sample(sink);
+    if (!sample) return;
+
+    GstCaps* caps = gst_sample_get_caps(sample);
+    GstBuffer* buf = gst_sample_get_buffer(sample);
+    GstVideoInfo vinfo;
+    if (!fullRes_.load(std::memory_order_acquire) || !caps || !buf ||
+        !gst_video_info_from_caps(&vinfo, caps)) {
+        gst_sample_unref(sample);
+        return;
+    }
+
+    auto* ms = new MappedSample;
+    if (!gst_buffer_map(buf, &ms->map, GST_MAP_READ)) {
+        delete ms;
+        gst_sample_unref(sample);
+        return;
+    }
+    ms->sample = sample;
+    ms->buffer = buf;
+
+    auto img = QSharedPointer<QImage>::create(
+        reinterpret_cast<const uchar*>(ms->map.data),
+        (int)GST_VIDEO_INFO_WIDTH(&vinfo), (int)GST_VIDEO_INFO_HEIGHT(&vinfo),
+        (int)GST_VIDEO_INFO_PLANE_STRIDE(&vinfo, 0),
+        QImage::Format_ARGB32, release_mapped_sample, ms);
+    if (img->isNull()) {
+        release_mapped_sample(ms);
+        return;
+    }
+
+    FrameMeta meta = makeFrameMeta(buf);
+    {
+        std::lock_guard<std::mutex> lk(latestMtx_);
+        latestFull_ = img;
+        latestFullMeta_ = std::move(meta);
+        ++fullSeq_;
+    }
+    if (!fullNotifyPending_.exchange(true, std::memory_order_acq_rel))
+        emit fullFrameReady();
+}
+
 void RtspViewerQt::run()
 {
     if (url_.isEmpty()) {
@@ -282,56 +797,84 @@ void RtspViewerQt::run()
 
     stopFlag_.store(false, std::memory_order_release);
 
+    // 重连状态（跨全量重建保持）
+    int     fullFailures = 0;        // 连续全量重建失败次数（首帧到达后清零）
+    qint64  reconnectT0Us = 0;       // 检测到断流的时刻（monotonicUs），0 = 非重连中
+    QString reconnectKind;
+    int     reconnects = 0;
+    int     warmReconnects = 0;
+    double  lastTtffMs = 0.0;
+    double  lastBusReactMs = 0.0;    // 最近一次 ERROR/EOS 投递 → 拉流循环发起重连
+    qint64  openT0Us = 0;            // 首次建管线时刻，首帧到达后清零
+    double  openTtffMs = 0.0;
+    quint64 lastGateDropped = 0;     // 最近一次出首帧前 IDR 闸门丢弃的 AU
+    int     keyUnitRequests = 0;
+    bool    firstStart = true;
+    bool    rebuildNow = false;      // 编码切换 / 线程预算变化：立即重建，不退避
+
+    // 自适应 latency（跨重连保持已学到的值）
+    LatencyController latCtl(LatencyController::Config{ kMinLatencyMs, kMaxLatencyMs });
+    {
+        const int hint = latencyMs_ > 0 ? latencyMs_ : 350;
+        latCtl.reset(hint);
+    }
+
 RECONNECT:
     if (stopFlag_.load(std::memory_order_acquire) || isInterruptionRequested()) return;
+    if (!firstStart && !rebuildNow) sleep_backoff(fullFailures++, stopFlag_, this);
+    if (firstStart) openT0Us = monotonicUs();
+    firstStart = false;
+    rebuildNow = false;
+    if (stopFlag_.load(std::memory_order_acquire) || isInterruptionRequested()) return;
 
+    const bool adaptive = adaptiveLatency_.load(std::memory_order_acquire);
     int latency = latencyMs_;
     if (latency <= 0) latency = 350;
-    latency = std::clamp(latency, 300, 600);
+    latency = std::clamp(adaptive ? latCtl.latencyMs() : latency, kMinLatencyMs, kMaxLatencyMs);
+    bool dropOnLatency = dropOnLatency_.load(std::memory_order_acquire);
 
     // Only loop wait-time, not media latency.
     const GstClockTime pullTimeout = 40 * GST_MSECOND;
 
-    const bool haveD3D11 =
-        hasFactory("rtph264depay") &&
-        hasFactory("h264parse") &&
-        hasFactory("d3d11h264dec") &&
-        hasFactory("d3d11convert") &&
-        hasFactory("d3d11download");
+    const bool zeroCopy = zeroCopy_.load(std::memory_order_acquire);
 
-    const bool haveSW =
-        hasFactory("rtph264depay") &&
-        hasFactory("h264parse") &&
-        hasFactory("avdec_h264") &&
-        hasFactory("videoconvert");
+    // 编码：默认 H264，SDP 协商出其他编码后记住（codec_），之后的重建直接用对应的链
+    const VideoCodec codec = (VideoCodec)codec_.load(std::memory_order_acquire);
+    const CodecChain& cc = codec_chain(codec);
+    const DecoderCandidate* dec = best_decoder(cc);
 
     QString pipeStr;
     QString decoderTag;
 
-    if (haveD3D11) {
-        pipeStr = build_hw_d3d11_pipeline_udp(url_, latency);
-        decoderTag = "d3d11(h264)->BGRA(download)";
-    } else if (haveSW) {
-        pipeStr = build_sw_pipeline_udp(url_, latency);
-        decoderTag = "avdec_h264";
+    rebuildRequested_.store(false, std::memory_order_release);
+    if (dec) {
+        const int threads = decodeThreads_.load(std::memory_order_acquire);
+        pipeStr = build_pipeline_udp(url_, latency, dropOnLatency, cc, *dec, threads);
+        decoderTag = dec->tag;
+        chainCodec_.store((int)codec, std::memory_order_release);
+        builtDecodeThreads_.store(std::strstr(dec->decode, "{threads}") ? threads : 0, std::memory_order_release);
     } else {
-        pipeStr = build_fallback_decodebin_udp(url_, latency);
-        decoderTag = "decodebin(fallback)";
+        pipeStr = build_fallback_decodebin_udp(url_, latency, dropOnLatency);
+        decoderTag = QString("decodebin(fallback,%1)").arg(codec_name(codec));
+        chainCodec_.store(-1, std::memory_order_release);   // decodebin 接受任意编码
+        builtDecodeThreads_.store(0, std::memory_order_release);
     }
+    codecMismatch_.store(false, std::memory_order_release);
 
     emit logLine(QString("[GST] pipeline: %1").arg(pipeStr));
-    emit logLine(QString("[GST] started (udp) | decoder=%1 | latency=%2ms | drop-on-latency=%3 | udpbuf=%4MB")
+    emit logLine(QString("[GST] started (udp) | decoder=%1 | latency=%2ms%6 | drop-on-latency=%3 | udpbuf=%4MB | frames=%5")
                      .arg(decoderTag)
                      .arg(latency)
-                     .arg(kDropOnLatency ? "true" : "false")
-                     .arg(kUdpRcvBufBytes / (1024 * 1024)));
+                     .arg(dropOnLatency ? "true" : "false")
+                     .arg(kUdpRcvBufBytes / (1024 * 1024))
+                     .arg(zeroCopy ? "zerocopy" : "copy")
+                     .arg(adaptive ? "(adaptive)" : ""));
 
     GError* err = nullptr;
     GstElement* pipeline = gst_parse_launch(pipeStr.toUtf8().constData(), &err);
     if (!pipeline) {
         emit logLine(QString("[GST] parse_launch failed: %1").arg(err ? qstr(err->message) : "unknown"));
         if (err) g_error_free(err);
-        QThread::msleep(200);
         goto RECONNECT;
     }
     if (err) g_error_free(err);
@@ -340,10 +883,118 @@ RECONNECT:
     if (!sinkElem) {
         emit logLine("[GST] appsink not found");
         gst_object_unref(pipeline);
-        QThread::msleep(200);
         goto RECONNECT;
     }
 
+    // 压缩域旁路（decodebin 兜底管线没有）
+    GstElement* esinkElem = gst_bin_get_by_name(GST_BIN(pipeline), "esink");
+    if (esinkElem) {
+        GstAppSinkCallbacks cbs = {};
+        cbs.new_sample = [](GstAppSink* s, gpointer self) -> GstFlowReturn {
+            static_cast<RtspViewerQt*>(self)->onEncodedSample(s);
+            return GST_FLOW_OK;
+        };
+        gst_app_sink_set_callbacks(GST_APP_SINK(esinkElem), &cbs, this, nullptr);
+        gst_object_unref(esinkElem);
+    }
+    encodedTapAvailable_.store(esinkElem != nullptr, std::memory_order_release);
+
+    // 平面 YUV 旁路（decodebin 兜底管线没有）；valve 由拉流循环按 yuvTap_ 开关
+    GstElement* yuvValve = gst_bin_get_by_name(GST_BIN(pipeline), "yuvvalve");
+    bool yuvValveOpen = false;
+    if (GstElement* ysinkElem = gst_bin_get_by_name(GST_BIN(pipeline), "yuvsink")) {
+        GstAppSinkCallbacks cbs = {};
+        cbs.new_sample = [](GstAppSink* s, gpointer self) -> GstFlowReturn {
+            static_cast<RtspViewerQt*>(self)->onYuvSample(s);
+            return GST_FLOW_OK;
+        };
+        gst_app_sink_set_callbacks(GST_APP_SINK(ysinkElem), &cbs, this, nullptr);
+        gst_object_unref(ysinkElem);
+    }
+    yuvTapAvailable_.store(yuvValve != nullptr, std::memory_order_release);
+
+    // 预览缩放 / 全分辨率分支（decodebin 兜底管线没有：预览即全分辨率）
+    GstElement* pvCaps   = gst_bin_get_by_name(GST_BIN(pipeline), "pvcaps");
+    GstElement* pvValve  = gst_bin_get_by_name(GST_BIN(pipeline), "pvvalve");
+    bool pvValveOpen = true;
+    bool decodeActive = true;        // decq 入口未丢弃（兜底管线恒为 true）
+    quint64 decodedSeen = 0;         // 预览/解码关闭时的存活计数（见 liveFrames）
+    GstElement* fullValve = gst_bin_get_by_name(GST_BIN(pipeline), "fullvalve");
+    int  pvWidthApplied = 0;
+    bool fullValveOpen = false;
+    if (GstElement* fsinkElem = gst_bin_get_by_name(GST_BIN(pipeline), "fullsink")) {
+        GstAppSinkCallbacks cbs = {};
+        cbs.new_sample = [](GstAppSink* s, gpointer self) -> GstFlowReturn {
+            static_cast<RtspViewerQt*>(self)->onFullSample(s);
+            return GST_FLOW_OK;
+        };
+        gst_app_sink_set_callbacks(GST_APP_SINK(fsinkElem), &cbs, this, nullptr);
+        gst_object_unref(fsinkElem);
+    }
+    fullResAvailable_.store(fullValve != nullptr, std::memory_order_release);
+    sourceW_.store(0, std::memory_order_release);
+    sourceH_.store(0, std::memory_order_release);
+
+    // 逐帧元数据：srcq 入口看 RTP 包，dt 入口看解码输出（兜底管线没有 dt）
+    resetFrameTrack();
+    if (GstElement* q = gst_bin_get_by_name(GST_BIN(pipeline), "srcq")) {
+        GstPad* pad = gst_element_get_static_pad(q, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+                          [](GstPad*, GstPadProbeInfo* info, gpointer self) -> GstPadProbeReturn {
+                              static_cast<RtspViewerQt*>(self)->onRtpPacket(GST_PAD_PROBE_INFO_BUFFER(info));
+                              return GST_PAD_PROBE_OK;
+                          }, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(q);
+    }
+    // 兜底管线（decodebin）没有 et，不设闸门
+    idrGate_.store(false, std::memory_order_release);
+    bool hasIdrGate = false;
+    if (GstElement* et = gst_bin_get_by_name(GST_BIN(pipeline), "et")) {
+        GstPad* pad = gst_element_get_static_pad(et, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+                          [](GstPad*, GstPadProbeInfo* info, gpointer self) -> GstPadProbeReturn {
+                              return static_cast<RtspViewerQt*>(self)->onParsedBuffer(GST_PAD_PROBE_INFO_BUFFER(info))
+                                         ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+                          }, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(et);
+        armIdrGate();
+        hasIdrGate = true;
+    }
+    idrGateAvailable_.store(hasIdrGate, std::memory_order_release);
+    decodeResync_.store(false, std::memory_order_release);   // 新管线的解码器从 IDR 闸门之后开始
+    bool hasDecodeGate = false;
+    if (GstElement* dq = gst_bin_get_by_name(GST_BIN(pipeline), "decq")) {
+        hasDecodeGate = true;
+        GstPad* pad = gst_element_get_static_pad(dq, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+                          [](GstPad*, GstPadProbeInfo* info, gpointer self) -> GstPadProbeReturn {
+                              return static_cast<RtspViewerQt*>(self)->onPreDecodeBuffer(GST_PAD_PROBE_INFO_BUFFER(info))
+                                         ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+                          }, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(dq);
+    }
+    if (GstElement* dt = gst_bin_get_by_name(GST_BIN(pipeline), "dt")) {
+        GstPad* pad = gst_element_get_static_pad(dt, "sink");
+        gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER,
+                          [](GstPad*, GstPadProbeInfo* info, gpointer self) -> GstPadProbeReturn {
+                              static_cast<RtspViewerQt*>(self)->onDecodedBuffer(GST_PAD_PROBE_INFO_BUFFER(info));
+                              return GST_PAD_PROBE_OK;
+                          }, this, nullptr);
+        gst_object_unref(pad);
+        gst_object_unref(dt);
+    }
+
+    GstElement* srcElem = gst_bin_get_by_name(GST_BIN(pipeline), "src");
+    if (srcElem) {
+        g_signal_connect(srcElem, "pad-added",
+                         G_CALLBACK(+[](GstElement* e, GstPad* pad, gpointer self) {
+                             static_cast<RtspViewerQt*>(self)->onSourcePadAdded(e, pad);
+                         }), this);
+    }
+
     GstAppSink* appsink = GST_APP_SINK(sinkElem);
     gst_app_sink_set_emit_signals(appsink, FALSE);
     gst_app_sink_set_drop(appsink, TRUE);
@@ -358,100 +1009,243 @@ RECONNECT:
         gst_caps_unref(caps);
     }
 
+    // 总线消息在投递线程处理（见 BusWatch），须在 PLAYING 之前装好
+    BusWatch busWatch;
+    busWatch.viewer = this;
+    busWatch.pipeline = pipeline;
+    install_bus_watch(pipeline, &busWatch);
+
     gst_element_set_state(pipeline, GST_STATE_PLAYING);
 
     QString stateErr;
     if (!wait_playing_or_fail(pipeline, 2000, stateErr)) {
         emit logLine(QString("[GST] failed to reach PLAYING: %1").arg(stateErr));
-        pump_bus(pipeline, [&](const QString& s){ emit logLine(s); }, nullptr);
         gst_element_set_state(pipeline, GST_STATE_NULL);
+        install_bus_watch(pipeline, nullptr);
+        if (srcElem) gst_object_unref(srcElem);
+        if (yuvValve) gst_object_unref(yuvValve);
+        if (pvCaps) gst_object_unref(pvCaps);
+        if (pvValve) gst_object_unref(pvValve);
+        if (fullValve) gst_object_unref(fullValve);
         gst_object_unref(sinkElem);
         gst_object_unref(pipeline);
-        QThread::msleep(200);
+        if (reconnectT0Us == 0) reconnectT0Us = monotonicUs();
+        reconnectKind = "full";
         goto RECONNECT;
     }
 
-    bool needReconnect = false;
     int  no_sample_cnt = 0;
+    bool warmPending = false;        // 热重启已发出，尚未收到首帧
+    JitterBufferStats jbPrev;        // 上个窗口的累计值（新会话计数归零时重新基准）
+    RtpSessionStats   rsPrev;
+    QString latencyReason = latCtl.reason();
     bool printedCaps = false;
-    int  busPumpTick = 0;
-    int  warmupSkip = 2;   // 丢弃前 2 帧，规避解码器首帧未初始化（绿帧）
+    qint64 keyReqLastUs = 0;         // 关键帧请求限频（等 IDR 期间每秒最多重发一次）
+    int  warmupSkip = hasIdrGate ? 0 : 2;   // 兜底管线无 IDR 闸门：丢弃前 2 帧，规避解码器首帧未初始化（绿帧）
 
-    std::array<QSharedPointer<QImage>, 5> pool;
-    int poolIdx = 0;
     int poolW = 0, poolH = 0;
-
-    auto ensurePool = [&](int w, int h) {
-        bool ok = (w == poolW && h == poolH);
-        if (ok) for (auto& p : pool) if (!p) { ok = false; break; }
-        if (ok) return;
-        poolW = w; poolH = h;
-        for (auto& p : pool)
-            p = QSharedPointer<QImage>::create(poolW, poolH, QImage::Format_ARGB32);
-        poolIdx = 0;
-        emit logLine(QString("[GST] QImage pool recreated: %1x%2").arg(poolW).arg(poolH));
-    };
+    quint64 poolDropsReported = framePool_.exhaustedCount();
 
     QElapsedTimer tPerf; tPerf.start();
     qint64 frames = 0;
-#ifndef QT_NO_DEBUG
-    qint64 copyNsAcc = 0;
     QElapsedTimer tWall; tWall.start();
-    qint64 lastSampleWallMs = -1;
+    qint64 lastSampleWallUs = -1;
     qint64 lastAnyWallMs = tWall.elapsed();
     qint64 stallMaxMs = 0;
-    std::vector<double> gapsMs; gapsMs.reserve(256);
-    double gapSum = 0.0;
     double jitterSqSum = 0.0;
+    int    jitterN = 0;
     int gapGt80 = 0;
     int gapGt120 = 0;
-    double gapMin = 1e9;
-    double gapMax = 0.0;
     double nominalGap = 1000.0 / 25.0;
-#endif
+
+    // 常量内存直方图：2 s 子窗口 × 15 = 30 s 滚动
+    RollingLatencyHistogram gapHist(15), copyHist(15), pullHist(15);
+    // 采集（发送端 SR 墙钟）→ appsink
+    RollingLatencyHistogram captureHist(15);
+    bool srSyncLogged = false;
+
+    // 断流：先热重启 rtspsrc；热重启后仍未出首帧又失败的，返回 false 走全量重建
+    auto tryWarmRestart = [&](const QString& why) -> bool {
+        if (reconnectT0Us == 0) reconnectT0Us = monotonicUs();
+        if (warmPending || !srcElem) return false;
+
+        emit logLine(QString("[GST] %1, warm restart rtspsrc").arg(why));
+        if (!restart_source(pipeline, srcElem, url_, &busWatch)) {
+            emit logLine("[GST] warm restart failed, full rebuild");
+            return false;
+        }
+        {
+            // 新会话 PTS 不连续，预录缓冲作废
+            std::lock_guard<std::mutex> lk(tapMtx_);
+            preEventRing_.clear();
+        }
+        resetFrameTrack();   // 新会话 RTP 时间戳/PTS 重新起算
+        if (hasIdrGate) armIdrGate();
+        keyReqLastUs = 0;
+        warmupSkip = hasIdrGate ? 0 : 2;
+        warmPending = true;
+        reconnectKind = "warm";
+        ++warmReconnects;
+        no_sample_cnt = 0;
+        printedCaps = false;
+        lastSampleWallUs = -1;
+        jbPrev = JitterBufferStats{};
+        rsPrev = RtpSessionStats{};
+        return true;
+    };
+
+    // 拉不到预览样本时的存活依据：解码开着看解码输出，关着看到达 decq 的 AU
+    auto liveFrames = [&]() -> quint64 {
+        return decodeActive ? decodedFrames_.load(std::memory_order_relaxed)
+                            : preDecodeFrames_.load(std::memory_order_relaxed);
+    };
+
+    // 关键帧请求（RTCP PLI/FIR）：打开/重连、解码重新打开后等 IDR 期间，以及检测到丢包时。
+    // 首帧耗时因此取决于 RTT 而不是相机的 GOP 长度
+    auto requestKeyUnit = [&](const QString& why, bool log) {
+        const qint64 nowUs = monotonicUs();
+        if (keyReqLastUs > 0 && nowUs - keyReqLastUs < 1000 * 1000) return;
+        keyReqLastUs = nowUs;
+        ++keyUnitRequests;
+        const bool ok = request_key_unit(pipeline);
+        if (log || !ok)
+            emit logLine(QString("[GST] request key unit (%1)%2").arg(why, ok ? "" : " - not handled upstream"));
+    };
 
     while (!stopFlag_.load(std::memory_order_acquire) && !isInterruptionRequested()) {
 
-#ifndef QT_NO_DEBUG
+        if (codecMismatch_.load(std::memory_order_acquire)) {
+            rebuildNow = true;
+            break;
+        }
+        if (rebuildRequested_.exchange(false, std::memory_order_acq_rel)) {
+            emit logLine(QString("[GST] rebuild requested (decode threads %1 -> %2)")
+                             .arg(builtDecodeThreads_.load(std::memory_order_acquire))
+                             .arg(decodeThreads_.load(std::memory_order_acquire)));
+            rebuildNow = true;
+            break;
+        }
+
+        if (yuvValve) {
+            const bool on = yuvTap_.load(std::memory_order_acquire);
+            if (on != yuvValveOpen) {
+                g_object_set(yuvValve, "drop", on ? FALSE : TRUE, NULL);
+                yuvValveOpen = on;
+                emit logLine(QString("[GST] yuv tap %1").arg(on ? "on" : "off"));
+            }
+        }
+        if (fullValve) {
+            const bool on = fullRes_.load(std::memory_order_acquire);
+            if (on != fullValveOpen) {
+                g_object_set(fullValve, "drop", on ? FALSE : TRUE, NULL);
+                fullValveOpen = on;
+                if (!on) {
+                    // 关闭后不再交付旧帧，同时尽早归还映射的缓冲
+                    std::lock_guard<std::mutex> lk(latestMtx_);
+                    latestFull_.reset();
+                    fullTakenSeq_ = fullSeq_;
+                    fullNotifyPending_.store(false, std::memory_order_release);
+                }
+                emit logLine(QString("[GST] full-res branch %1").arg(on ? "on" : "off"));
+            }
+        }
+        if (pvValve) {
+            const bool on = previewOn_.load(std::memory_order_acquire);
+            if (on != pvValveOpen) {
+                g_object_set(pvValve, "drop", on ? FALSE : TRUE, NULL);
+                pvValveOpen = on;
+                lastSampleWallUs = -1;                 // 关闭期间的空档不计入帧间隔统计
+                decodedSeen = liveFrames();
+                emit logLine(QString("[GST] preview branch %1").arg(on ? "on" : "off (background session)"));
+            }
+        }
+        if (hasDecodeGate) {
+            const bool on = decodeOn_.load(std::memory_order_acquire);
+            if (on != decodeActive) {
+                decodeActive = on;
+                lastSampleWallUs = -1;
+                decodedSeen = liveFrames();
+                emit logLine(QString("[GST] decoder %1").arg(on ? "on (waiting for IDR)" : "off (compressed taps only)"));
+            }
+        }
+        if (pvCaps) {
+            // 源尺寸未知前不缩放；达到源宽度时恢复直通（videoscale/d3d11convert 均透传）
+            const int srcW = sourceW_.load(std::memory_order_acquire);
+            const int srcH = sourceH_.load(std::memory_order_acquire);
+            int want = previewWidth_.load(std::memory_order_acquire);
+            if (srcW <= 0 || want >= srcW) want = 0;
+            if (want != pvWidthApplied) {
+                apply_preview_width(pvCaps, want, srcW, srcH);
+                pvWidthApplied = want;
+                emit logLine(QString("[GST] preview width -> %1").arg(want > 0 ? QString::number(want) : "source"));
+            }
+        }
+
         const qint64 nowAny = tWall.elapsed();
         const qint64 stall = nowAny - lastAnyWallMs;
         if (stall > stallMaxMs) stallMaxMs = stall;
-#endif
 
-        if ((busPumpTick++ & 7) == 0) {
-            pump_bus(pipeline, [&](const QString& s){ emit logLine(s); }, &needReconnect);
-            if (needReconnect) break;
+        if (busWatch.fault.load(std::memory_order_acquire)) {
+            // 断流计时从消息投递时刻算起，TTFF 因此包含总线响应延迟
+            const qint64 atUs = busWatch.faultAtUs.load(std::memory_order_relaxed);
+            const qint64 nowUs = monotonicUs();
+            if (atUs > 0) {
+                lastBusReactMs = (nowUs - atUs) / 1000.0;
+                if (reconnectT0Us == 0) reconnectT0Us = atUs;
+            }
+            emit logLine(QString("[GST] bus ERROR/EOS -> reconnect in %1ms").arg(lastBusReactMs, 0, 'f', 1));
+            busWatch.reset();
+            if (!tryWarmRestart("bus ERROR/EOS")) break;
+        }
+
+        // 会话收到 RTP 之后 rtpsession 才知道向哪个 SSRC 发 PLI
+        if (rtpSeen_.load(std::memory_order_acquire)) {
+            if (idrGate_.load(std::memory_order_acquire)) {
+                rtpLossSeen_.store(false, std::memory_order_relaxed);   // 等 IDR 期间已在请求
+                requestKeyUnit(reconnectT0Us > 0 ? reconnectKind : QStringLiteral("open"), true);
+            } else if (decodeActive && decodeResync_.load(std::memory_order_acquire)) {
+                rtpLossSeen_.store(false, std::memory_order_relaxed);
+                requestKeyUnit(QStringLiteral("decoder on"), true);
+            } else if (rtpLossSeen_.exchange(false, std::memory_order_acq_rel)) {
+                requestKeyUnit(QStringLiteral("loss"), false);
+            }
         }
 
         GstSample* sample = gst_app_sink_try_pull_sample(appsink, pullTimeout);
 
-#ifndef QT_NO_DEBUG
         lastAnyWallMs = tWall.elapsed();
-#endif
 
         if (!sample) {
-            if (++no_sample_cnt > 250) { // ~10s
+            // 预览关闭时 appsink 没有样本，解码器仍在出帧就算存活；解码关闭时看 AU 是否还在到达
+            if (!pvValveOpen || !decodeActive) {
+                const quint64 d = liveFrames();
+                if (d != decodedSeen) { decodedSeen = d; no_sample_cnt = 0; continue; }
+            }
+            // ~10s；热重启后等首帧 ~5s（含 RTSP 握手、jitterbuffer 延迟与等 IDR）
+            if (++no_sample_cnt > (warmPending ? 125 : 250)) {
                 emit logLine("[GST] no samples too long, reconnect...");
-                break;
+                if (!tryWarmRestart("no samples")) break;
             }
             continue;
         }
 
-#ifndef QT_NO_DEBUG
-        const qint64 nowMs = tWall.elapsed();
-        if (lastSampleWallMs >= 0) {
-            const double gap = (double)(nowMs - lastSampleWallMs);
-            gapsMs.push_back(gap);
-            gapSum += gap;
-            gapMin = std::min(gapMin, gap);
-            gapMax = std::max(gapMax, gap);
+        const qint64 nowUs = tWall.nsecsElapsed() / 1000;
+        if (lastSampleWallUs >= 0) {
+            const qint64 gapUs = nowUs - lastSampleWallUs;
+            gapHist.record(gapUs);
+            const double gap = gapUs / 1000.0;
             if (gap > 80.0)  ++gapGt80;
             if (gap > 120.0) ++gapGt120;
             const double j = gap - nominalGap;
             jitterSqSum += j * j;
+            ++jitterN;
+        }
+        lastSampleWallUs = nowUs;
+
+        {
+            const qint64 ageUs = sample_age_us(pipeline, sample);
+            if (ageUs >= 0) pullHist.record(ageUs);
         }
-        lastSampleWallMs = nowMs;
-#endif
 
         no_sample_cnt = 0;
 
@@ -459,10 +1253,8 @@ RECONNECT:
         if (!caps) { gst_sample_unref(sample); continue; }
 
         if (!printedCaps) {
-#ifndef QT_NO_DEBUG
             const double fpsFromCaps = caps_fps(caps, 25.0);
             if (fpsFromCaps > 1.0 && fpsFromCaps < 240.0) nominalGap = 1000.0 / fpsFromCaps;
-#endif
         }
 
         GstVideoInfo vinfo;
@@ -478,136 +1270,326 @@ RECONNECT:
 
         if (!printedCaps) {
             printedCaps = true;
+            // 解码输出（tee dt 之前）的尺寸 = 源尺寸；预览 sink 上看到的可能已缩放
+            int srcW = w, srcH = h;
+            if (GstElement* dt = gst_bin_get_by_name(GST_BIN(pipeline), "dt")) {
+                if (GstPad* dtSink = gst_element_get_static_pad(dt, "sink")) {
+                    if (GstCaps* dc = gst_pad_get_current_caps(dtSink)) {
+                        if (GstStructure* st = gst_caps_get_structure(dc, 0)) {
+                            gst_structure_get_int(st, "width", &srcW);
+                            gst_structure_get_int(st, "height", &srcH);
+                        }
+                        gst_caps_unref(dc);
+                    }
+                    gst_object_unref(dtSink);
+                }
+                gst_object_unref(dt);
+            }
+            sourceW_.store(srcW, std::memory_order_release);
+            sourceH_.store(srcH, std::memory_order_release);
             emit logLine(QString("[GST] negotiated caps: %1").arg(capsToString(caps)));
             emit logLine(QString("[GST] w=%1 h=%2 srcStride=%3 rowBytes=%4")
                              .arg(w).arg(h).arg(srcStride).arg(w * 4));
         }
 
-        // 预热：丢弃解码器首几帧（IDR 到达前可能输出未初始化绿帧）
+        // 预热：兜底管线丢弃解码器首几帧（IDR 到达前可能输出未初始化绿帧）
         if (warmupSkip > 0) {
             --warmupSkip;
             gst_sample_unref(sample);
             continue;
         }
 
-        ensurePool(w, h);
-
         GstBuffer* buffer = gst_sample_get_buffer(sample);
-        GstMapInfo map;
-        if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-
-#ifndef QT_NO_DEBUG
-            QElapsedTimer tCopy; tCopy.start();
-#endif
-            // 5 槽轮转：回绕间隔约 5 帧(~200ms)，远大于 UI 读帧耗时，
-            // 消费者读取期间不会被覆盖写（无需引用计数）
-            QSharedPointer<QImage> img = pool[poolIdx];
-            poolIdx = (poolIdx + 1) % (int)pool.size();
 
-            const int dstStride = img->bytesPerLine();
-            const uchar* src = reinterpret_cast<const uchar*>(map.data);
-            uchar* dst0 = img->bits();
+        FrameMeta meta = makeFrameMeta(buffer);
+        const qint64 captureUs = meta.captureUtcUs;
+        if (captureUs > 0) {
+            const qint64 c2aUs = wallClockUtcUs() - captureUs;
+            captureHist.record(c2aUs);
+            if (!srSyncLogged) {
+                srSyncLogged = true;
+                emit logLine(QString("[GST] RTCP SR sync acquired, capture->appsink=%1ms")
+                                 .arg(c2aUs / 1000.0, 0, 'f', 1));
+            }
+        }
 
-            const int rowBytes = w * 4;
+        QSharedPointer<QImage> poolImg;
+        if (!zeroCopy) {
+            // 只有所有消费者都释放后的槽才会回到这里，池满则丢帧（不撕裂）
+            poolImg = framePool_.acquire(w, h, QImage::Format_ARGB32);
+            if (w != poolW || h != poolH) {
+                poolW = w; poolH = h;
+                emit logLine(QString("[GST] QImage pool recreated: %1x%2 slots=%3 max=%4")
+                                 .arg(w).arg(h)
+                                 .arg(framePool_.slotCount())
+                                 .arg(framePool_.maxSlots()));
+            }
+            if (!poolImg) {
+                gst_sample_unref(sample);
+                continue;
+            }
+        }
 
-            if (srcStride == dstStride && srcStride == rowBytes) {
-                memcpy(dst0, src, (size_t)rowBytes * (size_t)h);
-            } else {
-                for (int y = 0; y < h; ++y) {
-                    memcpy(dst0 + y * dstStride, src + y * srcStride, rowBytes);
+        QElapsedTimer tCopy; tCopy.start();
+        QSharedPointer<QImage> img;
+
+        if (zeroCopy) {
+            // 零拷贝：sample 所有权转交给 QImage，映射保持到最后一个引用释放
+            auto* ms = new MappedSample;
+            if (buffer && gst_buffer_map(buffer, &ms->map, GST_MAP_READ)) {
+                ms->sample = sample;
+                ms->buffer = buffer;
+                sample = nullptr;
+
+                img = QSharedPointer<QImage>::create(
+                    reinterpret_cast<const uchar*>(ms->map.data), w, h, srcStride,
+                    QImage::Format_ARGB32, release_mapped_sample, ms);
+                if (img->isNull()) {
+                    // 构造失败时 Qt 不会调用 cleanup，这里手动释放
+                    release_mapped_sample(ms);
+                    img.reset();
+                    emit logLine("[GST] zero-copy wrap failed");
                 }
+            } else {
+                delete ms;
+                emit logLine("[GST] buffer_map failed");
             }
+        } else {
+            GstMapInfo map;
+            if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+                img = poolImg;
+
+                const int dstStride = img->bytesPerLine();
+                const uchar* src = reinterpret_cast<const uchar*>(map.data);
+                uchar* dst0 = img->bits();
+
+                const int rowBytes = w * 4;
+
+                if (srcStride == dstStride && srcStride == rowBytes) {
+                    memcpy(dst0, src, (size_t)rowBytes * (size_t)h);
+                } else {
+                    for (int y = 0; y < h; ++y) {
+                        memcpy(dst0 + y * dstStride, src + y * srcStride, rowBytes);
+                    }
+                }
 
-#ifndef QT_NO_DEBUG
-            copyNsAcc += tCopy.nsecsElapsed();
-#endif
-            gst_buffer_unmap(buffer, &map);
+                gst_buffer_unmap(buffer, &map);
+            } else {
+                emit logLine("[GST] buffer_map failed");
+            }
+        }
 
+        if (img) {
+            copyHist.record(tCopy.nsecsElapsed() / 1000);
             {
                 std::lock_guard<std::mutex> lk(latestMtx_);
+                meta.publishUs = monotonicUs();
                 latest_ = img;
+                latestMeta_ = std::move(meta);
                 latestSeq_.fetch_add(1, std::memory_order_release);
             }
+            // 合并通知：UI 未取走前不重复投递
+            if (!notifyPending_.exchange(true, std::memory_order_acq_rel))
+                emit frameReady();
 
             ++frames;
 
-        } else {
-            emit logLine("[GST] buffer_map failed");
+            if (openT0Us > 0 || reconnectT0Us > 0) {
+                lastGateDropped = idrGateDropped_.load(std::memory_order_relaxed);
+                const QString gateInfo = hasIdrGate
+                    ? QString(" (idr gate dropped %1 AU)").arg(lastGateDropped) : QString();
+                if (openT0Us > 0) {
+                    openTtffMs = (monotonicUs() - openT0Us) / 1000.0;
+                    emit logLine(QString("[GST] open time-to-first-frame=%1ms%2")
+                                     .arg(openTtffMs, 0, 'f', 0).arg(gateInfo));
+                    openT0Us = 0;
+                }
+                if (reconnectT0Us > 0) {
+                    lastTtffMs = (monotonicUs() - reconnectT0Us) / 1000.0;
+                    ++reconnects;
+                    emit logLine(QString("[GST] reconnect(%1) time-to-first-frame=%2ms%3")
+                                     .arg(reconnectKind)
+                                     .arg(lastTtffMs, 0, 'f', 0).arg(gateInfo));
+                    reconnectT0Us = 0;
+                }
+            }
+            warmPending = false;
+            fullFailures = 0;
         }
 
-        gst_sample_unref(sample);
-
-        if ((busPumpTick & 15) == 0) {
-            pump_bus(pipeline, [&](const QString& s){ emit logLine(s); }, &needReconnect);
-            if (needReconnect) break;
-        }
+        if (sample) gst_sample_unref(sample);
 
         if (tPerf.elapsed() > 2000) {
-#ifndef QT_NO_DEBUG
+            const quint64 poolDrops = framePool_.exhaustedCount();
+            if (poolDrops != poolDropsReported) {
+                emit logLine(QString("[GST] frame pool exhausted, dropped %1 frame(s) (total=%2 slots=%3/%4)")
+                                 .arg(poolDrops - poolDropsReported)
+                                 .arg(poolDrops)
+                                 .arg(framePool_.slotCount())
+                                 .arg(framePool_.maxSlots()));
+                poolDropsReported = poolDrops;
+            }
             const double sec = std::max(0.001, tPerf.elapsed() / 1000.0);
-            const double fps = frames / sec;
-            const double copyMs = (copyNsAcc / 1e6) / std::max<qint64>(1, frames);
-
-            double gapAvg = 0.0;
-            double p50 = 0.0, p90 = 0.0, p99 = 0.0;
-            double jitterRms = 0.0;
-            const int nGap = (int)gapsMs.size();
-            if (nGap > 0) {
-                gapAvg = gapSum / (double)nGap;
-                std::vector<double> tmp = gapsMs;
-                p50 = percentile_ms(tmp, 0.50);
-                p90 = percentile_ms(tmp, 0.90);
-                p99 = percentile_ms(tmp, 0.99);
-                jitterRms = std::sqrt(jitterSqSum / (double)nGap);
-            } else {
-                gapMin = 0.0;
-                gapMax = 0.0;
+
+            // jitterbuffer 窗口增量（会话重建后累计值变小 → 以当前值为增量）
+            JitterBufferStats jb;
+            if (srcElem) jb = read_jitterbuffer_stats(srcElem);
+            auto delta = [](quint64 now, quint64 prev) { return now >= prev ? now - prev : now; };
+            const quint64 jbPushed = delta(jb.pushed, jbPrev.pushed);
+            const quint64 jbLost   = delta(jb.lost, jbPrev.lost);
+            const quint64 jbLate   = delta(jb.late, jbPrev.late);
+            const quint64 jbDup    = delta(jb.duplicates, jbPrev.duplicates);
+            jbPrev = jb;
+
+            // 网络丢包（jitterbuffer 之前）；累计值变小 = 新会话
+            RtpSessionStats rs;
+            if (srcElem) rs = read_rtpsession_stats(srcElem);
+            qint64 netLost = rs.packetsLost - rsPrev.packetsLost;
+            if (rs.packetsLost < rsPrev.packetsLost) netLost = std::max<qint64>(0, rs.packetsLost);
+            netLost = std::max<qint64>(0, netLost);
+            rsPrev = rs;
+
+            // 自适应 latency：热重启等首帧期间不调（计数无意义）
+            const bool dropNow = dropOnLatency_.load(std::memory_order_acquire);
+            bool applyProps = dropNow != dropOnLatency;
+            dropOnLatency = dropNow;
+            if (adaptiveLatency_.load(std::memory_order_acquire) && !warmPending && jb.count > 0) {
+                LatencyController::Window lw;
+                lw.netJitterMs  = jb.avgJitterMs;
+                lw.nominalGapMs = nominalGap;
+                lw.pushed = jbPushed;
+                lw.lost   = jbLost;
+                lw.late   = jbLate;
+                lw.stalls = gapGt120;
+                if (latCtl.update(lw)) {
+                    const int prevLatency = latency;
+                    latency = latCtl.latencyMs();
+                    latencyReason = latCtl.reason();
+                    applyProps = true;
+                    emit logLine(QString("[LAT] %1 -> %2ms | %3").arg(prevLatency).arg(latency).arg(latencyReason));
+                    emit latencyChanged(latency, latencyReason);
+                }
+            }
+            if (applyProps && srcElem) apply_jitterbuffer_props(srcElem, latency, dropOnLatency);
+
+            StreamStats st;
+            st.updatedUs    = monotonicUs();
+            st.fps          = frames / sec;
+            st.latencyMs    = latency;
+            st.decoder      = decoderTag;
+            st.codec        = codec_name(codec);
+            st.zeroCopy     = zeroCopy;
+            st.nominalGapMs = nominalGap;
+            st.jitterRmsMs  = jitterN > 0 ? std::sqrt(jitterSqSum / (double)jitterN) : 0.0;
+            st.stallMaxMs   = stallMaxMs;
+            st.gapGt80      = gapGt80;
+            st.gapGt120     = gapGt120;
+            st.poolDrops    = poolDrops;
+            st.gap  = gapHist.current().summary();
+            st.copy = copyHist.current().summary();
+            st.pull = pullHist.current().summary();
+            st.gapRolling  = gapHist.aggregate().summary();
+            st.copyRolling = copyHist.aggregate().summary();
+            st.pullRolling = pullHist.aggregate().summary();
+            st.capture        = captureHist.current().summary();
+            st.captureRolling = captureHist.aggregate().summary();
+            st.reconnects     = reconnects;
+            st.warmReconnects = warmReconnects;
+            st.lastTtffMs     = lastTtffMs;
+            st.lastBusReactMs = lastBusReactMs;
+            st.openTtffMs     = openTtffMs;
+            st.idrGateDropped = lastGateDropped;
+            st.keyUnitRequests = keyUnitRequests;
+            st.latencyReason  = latencyReason;
+            st.dropOnLatency  = dropOnLatency;
+            st.jbLost         = jbLost;
+            st.jbLate         = jbLate;
+            st.jbJitterMs     = jb.avgJitterMs;
+            st.jbDuplicates   = jbDup;
+            st.netLost        = (quint64)netLost;
+            st.jbLostPerSec   = jbLost / sec;
+            st.jbLatePerSec   = jbLate / sec;
+            st.jbDupPerSec    = jbDup / sec;
+            st.netLostPerSec  = netLost / sec;
+            {
+                std::lock_guard<std::mutex> lk(statsMtx_);
+                stats_ = st;
             }
 
-            emit logLine(QString("[PERF] fps=%1 copy=%2ms decoder=%3 transport=udp latency=%4ms | "
-                                 "gap_avg=%5ms p50=%6 p90=%7 p99=%8 min=%9 max=%10 gt80=%11 gt120=%12 "
-                                 "stall_max=%13ms jitter_rms=%14ms nominalGap=%15ms")
-                             .arg(fps, 0, 'f', 1)
-                             .arg(copyMs, 0, 'f', 3)
+            // 有丢包/迟到/重复时才输出（release 同样输出），用来区分网络问题与解码问题
+            if (netLost > 0 || jbLost > 0 || jbLate > 0 || jbDup > 0) {
+                emit logLine(QString("[NET] net_lost=%1/s jb_lost=%2/s late=%3/s dup=%4/s jitter=%5ms pool_drops=%6")
+                                 .arg(st.netLostPerSec, 0, 'f', 1)
+                                 .arg(st.jbLostPerSec, 0, 'f', 1)
+                                 .arg(st.jbLatePerSec, 0, 'f', 1)
+                                 .arg(st.jbDupPerSec, 0, 'f', 1)
+                                 .arg(jb.avgJitterMs, 0, 'f', 1)
+                                 .arg(poolDrops));
+            }
+
+#ifndef QT_NO_DEBUG
+            emit logLine(QString("[PERF] fps=%1 copy_p50=%2ms copy_p99=%3ms decoder=%4 transport=udp latency=%5ms | "
+                                 "gap_avg=%6ms p50=%7 p90=%8 p99=%9 max=%10 gt80=%11 gt120=%12 "
+                                 "stall_max=%13ms jitter_rms=%14ms nominalGap=%15ms pull_p50=%16ms pull_p99=%17ms "
+                                 "gap_p99_30s=%18ms capture_p50=%19ms capture_p99=%20ms frames=%21")
+                             .arg(st.fps, 0, 'f', 1)
+                             .arg(st.copy.p50Ms, 0, 'f', 3)
+                             .arg(st.copy.p99Ms, 0, 'f', 3)
                              .arg(decoderTag)
                              .arg(latency)
-                             .arg(gapAvg, 0, 'f', 1)
-                             .arg(p50, 0, 'f', 1)
-                             .arg(p90, 0, 'f', 1)
-                             .arg(p99, 0, 'f', 1)
-                             .arg(gapMin, 0, 'f', 1)
-                             .arg(gapMax, 0, 'f', 1)
+                             .arg(st.gap.avgMs, 0, 'f', 1)
+                             .arg(st.gap.p50Ms, 0, 'f', 1)
+                             .arg(st.gap.p90Ms, 0, 'f', 1)
+                             .arg(st.gap.p99Ms, 0, 'f', 1)
+                             .arg(st.gap.maxMs, 0, 'f', 1)
                              .arg(gapGt80)
                              .arg(gapGt120)
                              .arg(stallMaxMs)
-                             .arg(jitterRms, 0, 'f', 1)
-                             .arg(nominalGap, 0, 'f', 2));
+                             .arg(st.jitterRmsMs, 0, 'f', 1)
+                             .arg(nominalGap, 0, 'f', 2)
+                             .arg(st.pull.p50Ms, 0, 'f', 1)
+                             .arg(st.pull.p99Ms, 0, 'f', 1)
+                             .arg(st.gapRolling.p99Ms, 0, 'f', 1)
+                             .arg(st.capture.p50Ms, 0, 'f', 1)
+                             .arg(st.capture.p99Ms, 0, 'f', 1)
+                             .arg(zeroCopy ? "zerocopy" : "copy"));
 #endif
             tPerf.restart();
             frames = 0;
-#ifndef QT_NO_DEBUG
-            copyNsAcc = 0;
-            gapsMs.clear();
-            gapSum = 0.0;
+            gapHist.rotate();
+            copyHist.rotate();
+            pullHist.rotate();
+            captureHist.rotate();
             jitterSqSum = 0.0;
+            jitterN = 0;
             gapGt80 = 0;
             gapGt120 = 0;
-            gapMin = 1e9;
-            gapMax = 0.0;
             stallMaxMs = 0;
-#endif
         }
     }
 
     gst_element_set_state(pipeline, GST_STATE_NULL);
+    install_bus_watch(pipeline, nullptr);
     QThread::msleep(30);
 
+    {
+        // 新会话的 PTS 与旧会话不连续，预录缓冲作废
+        std::lock_guard<std::mutex> lk(tapMtx_);
+        preEventRing_.clear();
+    }
+
+    if (srcElem) gst_object_unref(srcElem);
+    if (yuvValve) gst_object_unref(yuvValve);
+    if (pvCaps) gst_object_unref(pvCaps);
+    if (pvValve) gst_object_unref(pvValve);
+    if (fullValve) gst_object_unref(fullValve);
     gst_object_unref(sinkElem);
     gst_object_unref(pipeline);
     emit logLine("[GST] stopped");
 
     if (!stopFlag_.load(std::memory_order_acquire) && !isInterruptionRequested()) {
-        QThread::msleep(200);
+        if (reconnectT0Us == 0) reconnectT0Us = monotonicUs();
+        reconnectKind = "full";
         goto RECONNECT;
     }
 }
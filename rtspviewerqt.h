@@ -6,8 +6,68 @@
 #include <QImage>
 #include <QString>
 #include <atomic>
+#include <memory>
 #include <mutex>
 
+#include "framepool.h"
+#include "gopringbuffer.h"
+#include "latencyhistogram.h"
+#include "myStruct.h"
+
+struct _GstAppSink;
+struct _GstElement;
+struct _GstPad;
+struct _GstBuffer;
+
+// 拉流统计快照（release 版同样可用）。每个统计窗口（~2 s）结束时由拉流线程发布。
+//   gap  : 相邻两帧到达 appsink 的间隔
+//   copy : 帧发布耗时（copy 模式为 memcpy，zero-copy 为包装）
+//   pull : 取出时样本相对其 PTS（running time）的滞后，含 jitterbuffer 延迟与解码耗时
+//   capture : 发送端采集墙钟（RTCP SR 映射）→ appsink，需两端时钟同步（本机回环时天然成立）
+struct StreamStats {
+    qint64  updatedUs = 0;        // RtspViewerQt::monotonicUs()，0 = 尚无数据
+    double  fps = 0.0;
+    int     latencyMs = 0;
+    QString decoder;
+    QString codec;                // "H264" | "H265"（SDP encoding-name）
+    bool    zeroCopy = false;
+    double  nominalGapMs = 0.0;
+    double  jitterRmsMs = 0.0;
+    qint64  stallMaxMs = 0;
+    int     gapGt80 = 0;
+    int     gapGt120 = 0;
+    quint64 poolDrops = 0;
+
+    // 重连：reconnects 为已恢复出帧的次数（含 warm），lastTtffMs 为最近一次断流→首帧耗时
+    int     reconnects = 0;
+    int     warmReconnects = 0;
+    double  lastTtffMs = 0.0;
+    double  lastBusReactMs = 0.0; // 最近一次总线 ERROR/EOS 投递 → 发起重连（有界：≤ 一个 pullTimeout）
+    double  openTtffMs = 0.0;     // 建管线（首次打开）→ 首个可显示帧
+    quint64 idrGateDropped = 0;   // 最近一次（重）连等 IDR 时丢弃的非关键 AU
+    int     keyUnitRequests = 0;  // 累计发出的关键帧请求（RTCP PLI/FIR）
+
+    // jitterbuffer：当前 latency（latencyMs）的最近一次调整原因，及本窗口迟到/丢包/重复增量与平均抖动
+    QString latencyReason;
+    bool    dropOnLatency = true;
+    quint64 jbLost = 0;
+    quint64 jbLate = 0;           // 到达时已超出 latency（drop-on-latency 时被丢弃）
+    quint64 jbDuplicates = 0;
+    double  jbJitterMs = 0.0;
+    double  jbLostPerSec = 0.0;
+    double  jbLatePerSec = 0.0;
+    double  jbDupPerSec = 0.0;
+
+    // rtpsession：本窗口网络丢包（按序号推算，jitterbuffer 之前）
+    quint64 netLost = 0;
+    double  netLostPerSec = 0.0;
+
+    // 最近一个窗口
+    LatencySummary gap, copy, pull, capture;
+    // 滚动窗口（最近 ~30 s）
+    LatencySummary gapRolling, copyRolling, pullRolling, captureRolling;
+};
+
 class RtspViewerQt : public QThread
 {
     Q_OBJECT
@@ -16,31 +76,214 @@ public:
     ~RtspViewerQt() override;
 
     void setUrl(const QString& url);
+    // 来源相机 SN，写入每帧 FrameMeta::sn
+    void setSn(const QString& sn) { sn_ = sn; }
 
     // latency hint (ms). If <=0, viewer will choose a sane default.
+    // With adaptive latency on, this is only the starting point.
     void setLatencyMs(int ms) { latencyMs_ = ms; }
 
+    // 自适应 jitterbuffer latency（默认开）：根据抖动/迟到/丢包/卡顿在 150–600ms 间带迟滞调整，
+    // 运行中直接改 rtpbin 属性，不重连。变化时发出 latencyChanged()。
+    void setAdaptiveLatency(bool on) { adaptiveLatency_.store(on, std::memory_order_release); }
+    // 软解线程数（avdec_h264 max-threads，0 = 自动）。下次（重）建管线时生效；硬解不受影响
+    void setDecodeThreads(int n) { decodeThreads_.store(n, std::memory_order_release); }
+    // 当前管线实际使用的软解线程数（硬解 / decodebin 兜底 / 未建管线时为 0）
+    int  builtDecodeThreads() const { return builtDecodeThreads_.load(std::memory_order_acquire); }
+    // 请求拉流线程尽快整管重建（不退避），用于让新的 setDecodeThreads 立即生效
+    void requestRebuild() { rebuildRequested_.store(true, std::memory_order_release); }
+
+    // drop-on-latency：运行中切换，下一个统计窗口生效
+    void setDropOnLatency(bool on)   { dropOnLatency_.store(on, std::memory_order_release); }
+
+    // false(default): memcpy each decoded frame into the QImage pool.
+    // true: QImage wraps the mapped GstBuffer directly; the sample stays
+    //       mapped/ref'd until the last QImage copy is released.
+    //       Consumers must treat frames as read-only (constBits()).
+    // Takes effect on the next (re)connect.
+    void setZeroCopy(bool on) { zeroCopy_.store(on, std::memory_order_release); }
+    bool zeroCopy() const     { return zeroCopy_.load(std::memory_order_acquire); }
+
+    // copy 模式帧池上限（槽数）。所有引用释放后槽位才回收；
+    // 池满仍无空闲槽时丢弃该帧并计入 poolDroppedFrames()。
+    void setFramePoolMaxSlots(int n) { framePool_.setMaxSlots(n); }
+    quint64 poolDroppedFrames() const { return framePool_.exhaustedCount(); }
+
+    // 压缩域旁路（h264parse 之后的 AU）。启用后每个 AU 发出 encodedPacket()，
+    // 由 GStreamer 流线程直接发出（跨线程 queued）。当前管线无旁路时 available=false。
+    // 启用瞬间若预录缓冲非空，先（在同一把锁内）发出 encodedPreroll()，保证顺序：
+    // 预录 AU 全部先于之后的实时 AU 到达接收方。
+    void setEncodedTapEnabled(bool on);
+    bool encodedTapEnabled() const     { return encodedTap_.load(std::memory_order_acquire); }
+    bool encodedTapAvailable() const   { return encodedTapAvailable_.load(std::memory_order_acquire); }
+
+    // 平面 YUV 旁路（解码输出直接下载为 I420/NV12，不经 RGB）。启用后每帧发出 yuvFrame()，
+    // 由 GStreamer 流线程直接发出（跨线程 queued），帧引用解码缓冲、零拷贝。
+    // 未被释放的帧超过 kMaxYuvInFlight 时丢弃新帧。当前管线无旁路（decodebin 兜底）时 available=false。
+    void setYuvTapEnabled(bool on) { yuvTap_.store(on, std::memory_order_release); }
+    bool yuvTapEnabled() const     { return yuvTap_.load(std::memory_order_acquire); }
+    bool yuvTapAvailable() const   { return yuvTapAvailable_.load(std::memory_order_acquire); }
+
+    // 预览分支缩放到 width（像素，偶数；0 或不小于源宽 = 不缩放），运行中改变会重新协商。
+    // 按窗口实际显示宽度设置，GUI 线程的拷贝/叠加/绘制随之按比例减少
+    void setPreviewWidth(int width);
+    // 预览分支开关（valve pvvalve，默认开）。后台会话（不显示、不录像）关闭：解码照常（参考链不断，
+    // 切回时立即有帧），但不再缩放/转 BGRA/拷进帧池。关闭期间按解码输出判断流是否存活。
+    // decodebin 兜底管线没有此 valve，关闭无效。
+    void setPreviewEnabled(bool on) { previewOn_.store(on, std::memory_order_release); }
+    // 解码开关（默认开）。关闭时在预解码队列 decq 入口丢弃 AU，解码器及其后各分支空闲，压缩域
+    // 旁路（预录/直通）照常；重新打开后丢到下一个 IDR 为止并请求关键帧，解码器不会见到残缺 GOP。
+    // 关闭期间按到达 decq 的 AU 判断流是否存活。decodebin 兜底管线没有 decq，关闭无效。
+    void setDecodeEnabled(bool on) { decodeOn_.store(on, std::memory_order_release); }
+    // 源（解码输出）尺寸；首帧前为 0
+    QSize sourceSize() const { return QSize(sourceW_.load(std::memory_order_acquire),
+                                            sourceH_.load(std::memory_order_acquire)); }
+
+    // 全分辨率 BGRA 分支（valve 默认关闭）。录像叠加、截图、放大超过 1:1 时打开，
+    // 用 takeLatestFullFrameIfNew() 取最新帧（零拷贝）。decodebin 兜底管线没有此分支，
+    // 此时预览帧本身就是全分辨率。
+    void setFullResEnabled(bool on) { fullRes_.store(on, std::memory_order_release); }
+    bool fullResAvailable() const   { return fullResAvailable_.load(std::memory_order_acquire); }
+    QSharedPointer<QImage> takeLatestFullFrameIfNew(FrameMeta* meta = nullptr);
+
+    // 是否有 IDR 闸门（解析输出 et）。decodebin 兜底管线没有，首帧可能是绿帧，
+    // 拉流端丢前 2 帧，显示端再按时间丢开播后的一小段
+    bool idrGateAvailable() const { return idrGateAvailable_.load(std::memory_order_acquire); }
+
+    // 预录缓冲：保留最近 seconds 秒压缩 AU（IDR 对齐，且不超过 maxBytes）。seconds<=0 关闭。
+    void setPreEventBuffer(int seconds, qint64 maxBytes);
+
+    // 当前（或下次建管线时）使用的编码；由 SDP encoding-name 自动切换并记住
+    VideoCodec codec() const { return (VideoCodec)codec_.load(std::memory_order_acquire); }
+
+    // 最近一次发布的统计（任意线程可调用）
+    StreamStats streamStats() const;
+
     // Non-blocking stop (thread exits by itself)
     void stop();
 
-    // UI thread calls this periodically (e.g., 60Hz).
+    // UI thread calls this on frameReady() (or polls).
     // Returns latest frame ONLY if a new one arrived since last take.
-    QSharedPointer<QImage> takeLatestFrameIfNew();
+    // meta (optional): the frame's envelope (PTS, RTP ts/seq, arrival/decode/publish
+    //   times, SN, sender capture wallclock from RTCP SR); see FrameMeta.
+    QSharedPointer<QImage> takeLatestFrameIfNew(FrameMeta* meta = nullptr);
+
+    // steady clock in microseconds, shared time base for arrival stamps
+    static qint64 monotonicUs();
+    // system clock (us since Unix epoch, UTC); compare with captureUtcUs
+    static qint64 wallClockUtcUs();
 
 signals:
     void logLine(const QString& s);
 
+    // Coalesced: emitted at most once per pending frame; re-armed by
+    // takeLatestFrameIfNew(). Connect with Qt::QueuedConnection.
+    void frameReady();
+    // 全分辨率分支出新帧（同样合并，由 takeLatestFullFrameIfNew() 重新武装）。
+    // 录像/截图按它取帧，不依赖预览流的节奏
+    void fullFrameReady();
+
+    // 自适应 latency 变化（拉流线程发出）
+    void latencyChanged(int ms, const QString& reason);
+
+    void encodedPacket(QSharedPointer<EncodedPacket> pkt);
+    void encodedPreroll(QVector<QSharedPointer<EncodedPacket>> pkts);
+    void yuvFrame(QSharedPointer<YuvFrame> frame);
+
 protected:
     void run() override;
 
 private:
+    void onEncodedSample(_GstAppSink* sink);
+    void onYuvSample(_GstAppSink* sink);
+    void onFullSample(_GstAppSink* sink);
+    void onSourcePadAdded(_GstElement* src, _GstPad* pad);
+
+    // 逐帧元数据跟踪：srcq 入口（RTP 包）与 tee dt 入口（解码输出）的 pad probe 按 PTS 记录，
+    // appsink 取帧时按 PTS 查回。固定槽位环，流线程写、取帧线程读，无分配。
+    struct FrameTrack {
+        qint64  ptsNs = -1;
+        quint32 rtpTs = 0;
+        int     rtpSeq = -1;
+        qint64  arrivalUs = 0;
+        qint64  arrivalUtcUs = -1;
+        qint64  decodeDoneUs = 0;
+    };
+    static constexpr int kFrameTrackSlots = 64;
+    void resetFrameTrack();
+    void onRtpPacket(_GstBuffer* buf);
+    // tee et 入口（parse 输出）：IDR 闸门打开前丢弃非关键 AU。返回 true = 丢弃
+    bool onParsedBuffer(_GstBuffer* buf);
+    void armIdrGate();
+    void onDecodedBuffer(_GstBuffer* buf);
+    bool onPreDecodeBuffer(_GstBuffer* buf);   // true = 丢弃（解码关闭，或重新打开后等 IDR）
+    FrameMeta makeFrameMeta(_GstBuffer* buf);
+
     QString url_;
+    QString sn_;
     std::atomic<bool> stopFlag_{false};
     int latencyMs_ = 0;
+    std::atomic<bool> adaptiveLatency_{true};
+    std::atomic<bool> dropOnLatency_{true};
+    std::atomic<int>  decodeThreads_{0};
+    std::atomic<int>  builtDecodeThreads_{0};
+    std::atomic<bool> rebuildRequested_{false};
+
+    // 编码选择：codec_ 为记住的编码（跨重建保持）；chainCodec_ 为当前管线的解码链（-1 = decodebin 任意）
+    std::atomic<int>  codec_{(int)VideoCodec::H264};
+    std::atomic<int>  chainCodec_{(int)VideoCodec::H264};
+    std::atomic<bool> codecMismatch_{false};
+    std::atomic<bool> zeroCopy_{false};
+    FramePool framePool_{5, 12};
+    std::atomic<bool> encodedTap_{false};
+    std::atomic<bool> encodedTapAvailable_{false};
+
+    static constexpr int kMaxYuvInFlight = 4;
+    std::atomic<bool> yuvTap_{false};
+    std::atomic<bool> yuvTapAvailable_{false};
+    std::shared_ptr<std::atomic<int>> yuvInFlight_ = std::make_shared<std::atomic<int>>(0);
+
+    std::atomic<int>  previewWidth_{0};
+    std::atomic<bool> previewOn_{true};
+    std::atomic<quint64> decodedFrames_{0};   // dt 入口计数（预览关闭时的存活判断）
+    std::atomic<bool>    decodeOn_{true};
+    std::atomic<bool>    decodeResync_{false};   // 解码重新打开，decq 入口等 IDR
+    std::atomic<quint64> preDecodeFrames_{0};    // decq 入口 AU 计数（解码关闭时的存活判断）
+    std::atomic<int>  sourceW_{0};
+    std::atomic<int>  sourceH_{0};
+    std::atomic<bool> fullRes_{false};
+    std::atomic<bool> fullResAvailable_{false};
+
+    // 预录缓冲（tapMtx_ 同时串行化 encodedPreroll / encodedPacket 的发出顺序）
+    std::mutex tapMtx_;
+    GopRingBuffer preEventRing_{0, 0};
+    std::atomic<bool> preEventOn_{false};
+
+    mutable std::mutex statsMtx_;
+    StreamStats stats_;
 
     // latest frame handoff
     std::mutex latestMtx_;
     QSharedPointer<QImage> latest_;
+    FrameMeta latestMeta_;
     std::atomic<uint64_t> latestSeq_{0};
     std::atomic<uint64_t> takenSeq_{0};
+    QSharedPointer<QImage> latestFull_;         // 以下受 latestMtx_ 保护
+    FrameMeta latestFullMeta_;
+    uint64_t fullSeq_ = 0;
+    uint64_t fullTakenSeq_ = 0;
+    std::atomic<bool> notifyPending_{false};
+    std::atomic<bool> fullNotifyPending_{false};
+
+    std::mutex trackMtx_;
+    FrameTrack track_[kFrameTrackSlots];
+    int trackHead_ = 0;
+    int lastRtpSeq_ = -1;                       // 受 trackMtx_ 保护；过 jitterbuffer 后序号跳变即丢包
+
+    // 启动/重连时先等 IDR：解码器只见到完整 GOP，不出绿帧，也不必按帧数/时间盲丢
+    std::atomic<bool>    idrGate_{false};
+    std::atomic<bool>    idrGateAvailable_{false};
+    std::atomic<quint64> idrGateDropped_{0};
+    std::atomic<bool>    rtpSeen_{false};      // 本会话已收到 RTP（此后才能发关键帧请求）
+    std::atomic<bool>    rtpLossSeen_{false};
 };
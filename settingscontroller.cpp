@@ -22,6 +22,7 @@ void SettingsController::load()
     setCaptureType(s.value("format/captureType", 0).toInt());
     setRecordType(s.value("format/recordType",   0).toInt());
     setOverlayEnabled(s.value("overlay/enabled", true).toBool());
+    setRecordPassthrough(s.value("record/passthrough", false).toBool());
     language_ = s.value("language/locale", "zh_CN").toString();
 }
 
@@ -32,6 +33,7 @@ void SettingsController::save()
     s.setValue("format/captureType", captureType_);
     s.setValue("format/recordType",  recordType_);
     s.setValue("overlay/enabled",    overlayEnabled_);
+    s.setValue("record/passthrough", recordPassthrough_);
 
     myRecordOptions opt;
     opt.capturePath     = capturePath_;
@@ -39,6 +41,7 @@ void SettingsController::save()
     opt.capturType      = static_cast<ImageFormat>(captureType_);
     opt.recordType      = static_cast<VideoContainer>(recordType_);
     opt.overlayEnabled  = overlayEnabled_;
+    opt.recordPassthrough = recordPassthrough_;
     emit settingsSaved(opt);
 }
 
@@ -11,6 +11,7 @@ class SettingsController : public QObject
     Q_PROPERTY(int     captureType   READ captureType   WRITE setCaptureType   NOTIFY captureTypeChanged)
     Q_PROPERTY(int     recordType    READ recordType    WRITE setRecordType    NOTIFY recordTypeChanged)
     Q_PROPERTY(bool    overlayEnabled READ overlayEnabled WRITE setOverlayEnabled NOTIFY overlayEnabledChanged)
+    Q_PROPERTY(bool    recordPassthrough READ recordPassthrough WRITE setRecordPassthrough NOTIFY recordPassthroughChanged)
     Q_PROPERTY(QString language      READ language                              NOTIFY languageChanged)
 
 public:
@@ -21,6 +22,7 @@ public:
     int     captureType()    const { return captureType_; }
     int     recordType()     const { return recordType_; }
     bool    overlayEnabled() const { return overlayEnabled_; }
+    bool    recordPassthrough() const { return recordPassthrough_; }
     QString language()       const { return language_; }
 
     void setCapturePath(const QString& v)  { if (capturePath_ == v) return; capturePath_ = v; emit capturePathChanged(); }
@@ -28,6 +30,7 @@ public:
     void setCaptureType(int v)             { if (captureType_ == v) return; captureType_ = v; emit captureTypeChanged(); }
     void setRecordType(int v)              { if (recordType_ == v) return; recordType_ = v; emit recordTypeChanged(); }
     void setOverlayEnabled(bool v)         { if (overlayEnabled_ == v) return; overlayEnabled_ = v; emit overlayEnabledChanged(); }
+    void setRecordPassthrough(bool v)      { if (recordPassthrough_ == v) return; recordPassthrough_ = v; emit recordPassthroughChanged(); }
 
     Q_INVOKABLE void load();
     Q_INVOKABLE void save();
@@ -43,6 +46,7 @@ signals:
     void captureTypeChanged();
     void recordTypeChanged();
     void overlayEnabledChanged();
+    void recordPassthroughChanged();
     void languageChanged();
     void settingsSaved(myRecordOptions opts);
     void requestClose();
@@ -54,5 +58,6 @@ private:
     int     captureType_    = 0;
     int     recordType_     = 0;
     bool    overlayEnabled_ = false;
+    bool    recordPassthrough_ = false;
     QString language_       = "zh_CN";
 };
@@ -0,0 +1,235 @@
+#include "streamsessionmanager.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QSettings>
+#include <QThread>
+#include <algorithm>
+#include <utility>
+
+StreamSessionManager::StreamSessionManager(QObject* parent)
+    : QObject(parent)
+{
+    QSettings s("SPwater", "CameraControl");
+    plannedSessions_ = std::max(1, s.value("viewer/plannedSessions", kDefaultPlannedSessions).toInt());
+    setDecodeThreadBudget(s.value("viewer/decodeThreadBudget", 0).toInt());
+}
+
+StreamSessionManager::~StreamSessionManager()
+{
+    closeAll();
+}
+
+void StreamSessionManager::setDecodeThreadBudget(int threads)
+{
+    threadBudget_ = threads > 0 ? threads : std::max(1, QThread::idealThreadCount());
+    rebalanceThreads();
+}
+
+void StreamSessionManager::setPlannedSessions(int n)
+{
+    plannedSessions_ = n > 0 ? n : kDefaultPlannedSessions;
+    rebalanceThreads();
+}
+
+// 正在解码的路数（按需启动的主码流、尚未退出的 viewer 也算一路）
+int StreamSessionManager::activeDecoders() const
+{
+    int n = sessions_.size() + retiring_.size();
+    for (const MainStream& m : mains_) if (m.viewer) ++n;
+    return n;
+}
+
+// 份额按预留路数与实际路数中较大者分：实际路数不超过预留时，开关会话不改变份额
+int StreamSessionManager::threadsPerSession() const
+{
+    return std::max(1, threadBudget_ / std::max(plannedSessions_, activeDecoders()));
+}
+
+void StreamSessionManager::rebalanceThreads()
+{
+    const int per = threadsPerSession();
+    int total = 0, rebuilds = 0;
+    auto apply = [&](RtspViewerQt* v) {
+        v->setDecodeThreads(per);
+        const int built = v->builtDecodeThreads();
+        if (built > per) {            // 份额缩小：旧管线的 max-threads 不会自己变，重建
+            v->requestRebuild();
+            ++rebuilds;
+        }
+        total += built > 0 ? std::min(built, per) : per;
+    };
+    for (RtspViewerQt* v : std::as_const(sessions_)) apply(v);
+    for (const MainStream& m : std::as_const(mains_))
+        if (m.viewer) apply(m.viewer);
+    // 退出中的 viewer 不再重建，按原线程数计入
+    for (RtspViewerQt* v : std::as_const(retiring_)) total += v->builtDecodeThreads();
+
+    if (rebuilds > 0 || total != lastTotalThreads_) {
+        lastTotalThreads_ = total;
+        qInfo().noquote() << QString("[SESSION] decode threads: %1/session x %2 decoders (planned %3), "
+                                     "effective total=%4 budget=%5%6")
+                                 .arg(per).arg(activeDecoders()).arg(plannedSessions_)
+                                 .arg(total).arg(threadBudget_)
+                                 .arg(rebuilds ? QString(", rebuilding %1").arg(rebuilds) : QString());
+    }
+}
+
+RtspViewerQt* StreamSessionManager::createViewer(const QString& sn, const QString& url, const QString& logTag)
+{
+    auto* v = new RtspViewerQt(this);
+    connect(v, &RtspViewerQt::logLine, this, [this, sn, logTag](const QString& s){
+        emit logLine(sn, logTag.isEmpty() ? s : logTag + " " + s);
+    });
+
+    v->setUrl(url);
+    v->setSn(sn);
+    {
+        // viewer/zeroCopy=true：帧直接引用解码器输出缓冲，省去每帧 8MB memcpy
+        QSettings s("SPwater", "CameraControl");
+        v->setZeroCopy(s.value("viewer/zeroCopy", false).toBool());
+        v->setFramePoolMaxSlots(s.value("viewer/framePoolMaxSlots", 12).toInt());
+        v->setAdaptiveLatency(s.value("viewer/adaptiveLatency", true).toBool());
+        v->setDropOnLatency(s.value("viewer/dropOnLatency", true).toBool());
+    }
+    return v;
+}
+
+RtspViewerQt* StreamSessionManager::open(const QString& sn, const QString& url, const QString& mainUrl)
+{
+    if (RtspViewerQt* v = sessions_.value(sn, nullptr)) return v;
+
+    RtspViewerQt* v = createViewer(sn, url, mainUrl.isEmpty() ? QString() : QStringLiteral("[sub]"));
+    v->setPreviewEnabled(sn == displayed_);
+    sessions_.insert(sn, v);
+    if (!mainUrl.isEmpty()) {
+        MainStream m;
+        m.url = mainUrl;
+        mains_.insert(sn, m);
+    }
+    rebalanceThreads();
+    qInfo().noquote() << QString("[SESSION] open %1%6 | sessions=%2 decodeThreads/session=%3 total=%4 (budget=%5)")
+                             .arg(sn).arg(sessions_.size()).arg(threadsPerSession()).arg(lastTotalThreads_)
+                             .arg(threadBudget_)
+                             .arg(mainUrl.isEmpty() ? "" : " (sub stream, main on demand)");
+
+    emit sessionOpened(sn, v);
+    v->start();
+    return v;
+}
+
+RtspViewerQt* StreamSessionManager::mainViewer(const QString& sn) const
+{
+    const auto it = mains_.constFind(sn);
+    if (it == mains_.cend()) return viewer(sn);
+    return it->viewer;
+}
+
+void StreamSessionManager::setMainWanted(const QString& sn, bool wanted, bool decode)
+{
+    auto it = mains_.find(sn);
+    if (it == mains_.end()) return;
+    MainStream& m = *it;
+
+    if (wanted) {
+        m.idleSinceMs = 0;
+        if (m.viewer) {
+            m.viewer->setDecodeEnabled(decode);
+            m.viewer->setPreviewEnabled(decode);
+            return;
+        }
+        m.viewer = createViewer(sn, m.url, QStringLiteral("[main]"));
+        m.viewer->setPreviewWidth(kMainThumbWidth);
+        m.viewer->setDecodeEnabled(decode);
+        m.viewer->setPreviewEnabled(decode);
+        rebalanceThreads();
+        qInfo().noquote() << QString("[SESSION] %1 main stream on%2").arg(sn, decode ? "" : " (compressed only)");
+        emit sessionOpened(sn, m.viewer);
+        m.viewer->start();
+        return;
+    }
+
+    if (!m.viewer) return;
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    if (m.idleSinceMs == 0) {
+        m.idleSinceMs = now;
+        return;
+    }
+    if (now - m.idleSinceMs < kMainLingerMs) return;
+    stopMain(sn, m, "idle");
+}
+
+void StreamSessionManager::releaseMain(const QString& sn)
+{
+    auto it = mains_.find(sn);
+    if (it == mains_.end() || !it->viewer) return;
+    stopMain(sn, *it, "released");
+}
+
+void StreamSessionManager::setDisplayed(const QString& sn)
+{
+    displayed_ = sn;
+    for (auto it = sessions_.cbegin(); it != sessions_.cend(); ++it)
+        it.value()->setPreviewEnabled(it.key() == sn);
+}
+
+void StreamSessionManager::stopMain(const QString& sn, MainStream& m, const char* why)
+{
+    RtspViewerQt* v = m.viewer;
+    m.viewer = nullptr;
+    m.idleSinceMs = 0;
+    retire(v);
+    qInfo().noquote() << QString("[SESSION] %1 main stream off (%2)").arg(sn, why);
+}
+
+void StreamSessionManager::retire(RtspViewerQt* v)
+{
+    retiring_.insert(v);
+    connect(v, &QThread::finished, this, [this, v]{
+        if (!retiring_.remove(v)) return;   // closeAll 已同步回收
+        v->deleteLater();
+        rebalanceThreads();
+    });
+    v->stop();
+    v->quit();
+    if (v->isFinished() && retiring_.remove(v)) {   // 线程已自行退出，不会再发 finished
+        v->deleteLater();
+        rebalanceThreads();
+    }
+}
+
+void StreamSessionManager::close(const QString& sn)
+{
+    RtspViewerQt* v = sessions_.take(sn);
+    if (!v) return;
+    RtspViewerQt* mv = mains_.take(sn).viewer;
+
+    emit sessionClosed(sn);
+    retire(v);
+    if (mv) retire(mv);
+
+    qInfo().noquote() << QString("[SESSION] close %1 | sessions=%2").arg(sn).arg(sessions_.size());
+}
+
+void StreamSessionManager::closeAll(int waitMs)
+{
+    const auto all = sessions_;
+    const auto mains = mains_;
+    const auto retiring = retiring_;
+    sessions_.clear();
+    mains_.clear();
+    retiring_.clear();
+    // 先全部发停止，再逐个等待，N 路并行退出（退出时必须等：viewer 是本对象的子对象）
+    for (RtspViewerQt* v : all) v->stop();
+    for (const MainStream& m : mains) if (m.viewer) m.viewer->stop();
+    for (RtspViewerQt* v : retiring) { v->wait(waitMs); v->deleteLater(); }
+    for (auto it = all.cbegin(); it != all.cend(); ++it) {
+        emit sessionClosed(it.key());
+        RtspViewerQt* v = it.value();
+        v->quit(); v->wait(waitMs); v->deleteLater();
+    }
+    for (const MainStream& m : mains) {
+        if (!m.viewer) continue;
+        m.viewer->quit(); m.viewer->wait(waitMs); m.viewer->deleteLater();
+    }
+}
@@ -0,0 +1,93 @@
+// streamsessionmanager.h
+// 多路拉流会话管理：按 SN 持有多个并发 RtspViewerQt，每路有独立的帧池、统计与重连状态
+// （都在各自的 RtspViewerQt 里），takeLatestFrameIfNew() 语义按会话独立。
+// 软解线程预算：进程内 avdec 线程总数上限（默认 = 逻辑核数）。每路分 budget / max(P, N)（至少 1），
+// P = viewer/plannedSessions（预计同时解码的路数，默认 4），N = 实际解码路数。max-threads 只能在
+// 建管线时设定：N <= P 时份额不变，先开的会话无需重建；N 超过 P 后份额缩小，已按更大份额建好
+// 管线的会话立即整管重建（短暂断流）。8–16 路 1080p 同时软解时总数不超过预算。
+//
+// 主/子码流：open() 给出 mainUrl 时为双码流会话——预览 viewer() 拉子码流（低分辨率），
+// 主码流 mainViewer() 按需启动：录像 / 截图 / 放大时 setMainWanted(sn, true)；不再需要后
+// 保留 kMainLingerMs 再停，避免反复缩放时频繁建链。单码流会话的 mainViewer() 就是 viewer()。
+// 只为预录缓冲/直通录像保持主码流时 decode=false：主码流只收压缩码流，不解码、不出缩略图。
+//
+// 后台会话：只有 setDisplayed() 指定的那一路打开预览分支；其余各路继续解码（切回即出画），
+// 但不做缩放/BGRA 转换/帧池拷贝。
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include "rtspviewerqt.h"
+
+class StreamSessionManager : public QObject
+{
+    Q_OBJECT
+public:
+    explicit StreamSessionManager(QObject* parent = nullptr);
+    ~StreamSessionManager() override;
+
+    // 已存在则直接返回（不重复拉流）；新建时按 QSettings viewer/* 配置并启动。
+    // url 为预览用的码流；mainUrl 非空时 url 是子码流，主码流按需启动
+    RtspViewerQt* open(const QString& sn, const QString& url, const QString& mainUrl = QString());
+    void close(const QString& sn);
+    void closeAll(int waitMs = 2000);
+
+    RtspViewerQt* viewer(const QString& sn) const { return sessions_.value(sn, nullptr); }
+    bool          isDual(const QString& sn) const { return mains_.contains(sn); }
+    // 全分辨率/录像来源：单码流 = viewer()；双码流 = 主码流（未启动时 nullptr）
+    RtspViewerQt* mainViewer(const QString& sn) const;
+    // 双码流：需要主码流时启动；不再需要满 kMainLingerMs 后停止（按预览帧节奏调用即可）。
+    // decode=false：只要压缩码流（预录缓冲），主码流不解码、不出预览缩略图
+    void setMainWanted(const QString& sn, bool wanted, bool decode = true);
+    // 立即停止主码流（切走显示 / 关闭预览时，不等 linger）
+    void releaseMain(const QString& sn);
+    // 当前显示的会话（空 = 都不显示）：其余会话关闭预览分支
+    void setDisplayed(const QString& sn);
+    bool          contains(const QString& sn) const { return sessions_.contains(sn); }
+    QStringList   sns() const { return sessions_.keys(); }
+    int           count() const { return sessions_.size(); }
+
+    // 进程内软解线程总预算（<=0 恢复默认：逻辑核数）
+    void setDecodeThreadBudget(int threads);
+    int  decodeThreadBudget() const { return threadBudget_; }
+    int  threadsPerSession() const;
+    // 预计同时解码的路数（<=0 恢复默认 4）：份额按它预留，避免逐路打开时先开的会话多占线程
+    void setPlannedSessions(int n);
+
+signals:
+    // 每个新启动的 viewer 都会发出（含按需启动的主码流），接收方据此连接录像旁路
+    void sessionOpened(const QString& sn, RtspViewerQt* viewer);
+    void sessionClosed(const QString& sn);
+    void logLine(const QString& sn, const QString& s);
+
+private:
+    static constexpr qint64 kMainLingerMs = 15000;
+    static constexpr int    kDefaultPlannedSessions = 4;
+    static constexpr int    kMainThumbWidth = 320;   // 主码流的预览分支不显示，缩到最小省掉整帧 BGRA 转换
+
+    struct MainStream {
+        QString       url;
+        RtspViewerQt* viewer = nullptr;
+        qint64        idleSinceMs = 0;   // 不再需要的起始时刻，0 = 仍需要
+    };
+
+    RtspViewerQt* createViewer(const QString& sn, const QString& url, const QString& logTag);
+    void stopMain(const QString& sn, MainStream& m, const char* why);
+    // 异步停止：不在 GUI 线程等待，线程退出后再释放并重新分配线程预算
+    void retire(RtspViewerQt* v);
+    int  activeDecoders() const;
+    // 下发份额；已建管线的软解线程数超过份额的会话请求重建
+    void rebalanceThreads();
+
+    QHash<QString, RtspViewerQt*> sessions_;
+    QHash<QString, MainStream>    mains_;
+    QSet<RtspViewerQt*>           retiring_;   // 已发停止、线程尚未退出（仍占解码线程）
+    QString displayed_;
+    int threadBudget_ = 0;
+    int plannedSessions_ = kDefaultPlannedSessions;
+    int lastTotalThreads_ = 0;   // 最近一次分配后的实际软解线程总数（日志用）
+};
@@ -0,0 +1,33 @@
+# 本地相机模拟器（RTSP + UDP 心跳 + 网络损伤），替代真机复现现场问题
+#   qmake tools/camera_emulator/camera_emulator.pro && make
+#   ./camera_emulator --sn=EMU001,EMU002 --loss=1 --jitter=30 --restart-every=60
+QT = core network
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = camera_emulator
+
+SOURCES += \
+    main.cpp \
+    impairer.cpp
+
+HEADERS += \
+    impairer.h
+
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += gstreamer-1.0 gstreamer-rtsp-server-1.0
+}
+
+win32 {
+    QMAKE_CXXFLAGS += -utf-8
+    GST_ROOT = E:/ThirdParty/Gstreamer/1.0/msvc_x86_64
+    INCLUDEPATH += \
+        $$GST_ROOT/include/gstreamer-1.0 \
+        $$GST_ROOT/include/glib-2.0 \
+        $$GST_ROOT/lib/glib-2.0/include
+    LIBS += \
+        "$$GST_ROOT/lib/gstreamer-1.0.lib" \
+        "$$GST_ROOT/lib/gstrtspserver-1.0.lib" \
+        "$$GST_ROOT/lib/glib-2.0.lib" \
+        "$$GST_ROOT/lib/gobject-2.0.lib"
+}
@@ -0,0 +1,165 @@
+// impairer.cpp
+#include "impairer.h"
+
+#include <chrono>
+
+extern "C" {
+#include <gst/gst.h>
+}
+
+static qint64 monotonicUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 工作线程重新推送的 buffer 会再次经过 probe，靠线程局部标记放行
+static thread_local bool t_bypass = false;
+
+Impairer::Impairer(GstPad* pad, const ImpairConfig& cfg)
+    : pad_(GST_PAD(gst_object_ref(pad)))
+    , cfg_(cfg)
+    , rng_(std::random_device{}())
+    , startUs_(monotonicUs())
+{
+    if (cfg_.delays())
+        worker_ = std::thread([this]{ workerLoop(); });
+
+    probeId_ = gst_pad_add_probe(pad_, (GstPadProbeType)(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_BUFFER_LIST),
+                                 [](GstPad*, GstPadProbeInfo* info, gpointer self) -> GstPadProbeReturn {
+                                     if (t_bypass) return GST_PAD_PROBE_OK;
+                                     auto* imp = static_cast<Impairer*>(self);
+                                     if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_BUFFER_LIST) {
+                                         GstBufferList* list = GST_PAD_PROBE_INFO_BUFFER_LIST(info);
+                                         GstBufferList* kept = imp->onBufferList(list);
+                                         if (!kept) return GST_PAD_PROBE_DROP;
+                                         if (kept != list) {
+                                             gst_buffer_list_unref(list);
+                                             GST_PAD_PROBE_INFO_DATA(info) = kept;
+                                         }
+                                         return GST_PAD_PROBE_OK;
+                                     }
+                                     GstBuffer* buf = GST_PAD_PROBE_INFO_BUFFER(info);
+                                     return imp->onBuffer(buf) ? GST_PAD_PROBE_DROP : GST_PAD_PROBE_OK;
+                                 }, this, nullptr);
+}
+
+Impairer::~Impairer()
+{
+    gst_pad_remove_probe(pad_, probeId_);
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        stop_ = true;
+    }
+    cv_.notify_all();
+    if (worker_.joinable()) worker_.join();
+    while (!queue_.empty()) {
+        gst_buffer_unref(queue_.top().buf);
+        queue_.pop();
+    }
+    gst_object_unref(pad_);
+}
+
+Impairer::Counters Impairer::counters() const
+{
+    std::lock_guard<std::mutex> lk(mtx_);
+    return counters_;
+}
+
+// 流线程调用（payloader 推送线程，单线程）
+bool Impairer::onBuffer(GstBuffer* buf)
+{
+    // 突发：Gilbert-Elliott，坏状态平均持续 burstLen 包
+    if (inBurst_) {
+        if (uni_(rng_) < 1.0 / qMax(1, cfg_.burstLen)) inBurst_ = false;
+    } else if (cfg_.burstPct > 0.0 && uni_(rng_) * 100.0 < cfg_.burstPct) {
+        inBurst_ = true;
+    }
+    if (inBurst_) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        ++counters_.burstLost;
+        return true;
+    }
+    if (cfg_.lossPct > 0.0 && uni_(rng_) * 100.0 < cfg_.lossPct) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        ++counters_.lost;
+        return true;
+    }
+
+    if (!cfg_.delays()) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        ++counters_.passed;
+        return false;
+    }
+
+    const qint64 now = monotonicUs();
+    qint64 release = now;
+    if (cfg_.jitterMs > 0)
+        release += (qint64)(uni_(rng_) * cfg_.jitterMs * 1000.0);
+    if (cfg_.stallEverySec > 0 && cfg_.stallMs > 0) {
+        const qint64 period = (qint64)cfg_.stallEverySec * 1000000;
+        const qint64 phase = (now - startUs_) % period;
+        const qint64 stallBeg = period - (qint64)cfg_.stallMs * 1000;
+        if (phase >= stallBeg) release = qMax(release, now + (period - phase));
+    }
+
+    const bool reorder = cfg_.reorderPct > 0.0 && uni_(rng_) * 100.0 < cfg_.reorderPct;
+    if (reorder) {
+        release += (qint64)(cfg_.jitterMs + cfg_.reorderMs) * 1000;
+    } else {
+        release = qMax(release, lastReleaseUs_);
+        lastReleaseUs_ = release;
+    }
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        queue_.push(Pending{ release, order_++, gst_buffer_ref(buf) });
+        ++counters_.delayed;
+        if (reorder) ++counters_.reordered;
+    }
+    cv_.notify_one();
+    return true;
+}
+
+GstBufferList* Impairer::onBufferList(GstBufferList* list)
+{
+    const guint n = gst_buffer_list_length(list);
+    GstBufferList* kept = gst_buffer_list_new_sized(n);
+    for (guint i = 0; i < n; ++i) {
+        GstBuffer* buf = gst_buffer_list_get(list, i);
+        if (!onBuffer(buf)) gst_buffer_list_add(kept, gst_buffer_ref(buf));
+    }
+    const guint left = gst_buffer_list_length(kept);
+    if (left == n) {
+        gst_buffer_list_unref(kept);
+        return list;
+    }
+    if (left == 0) {
+        gst_buffer_list_unref(kept);
+        return nullptr;
+    }
+    return kept;
+}
+
+void Impairer::workerLoop()
+{
+    t_bypass = true;
+    std::unique_lock<std::mutex> lk(mtx_);
+    while (!stop_) {
+        if (queue_.empty()) {
+            cv_.wait(lk);
+            continue;
+        }
+        const qint64 wait = queue_.top().releaseUs - monotonicUs();
+        if (wait > 0) {
+            cv_.wait_for(lk, std::chrono::microseconds(wait));
+            continue;
+        }
+        GstBuffer* buf = queue_.top().buf;
+        queue_.pop();
+        ++counters_.passed;
+        lk.unlock();
+        gst_pad_push(pad_, buf);   // 下游（rtpbin）的 stream lock 负责与流线程的推送串行化
+        lk.lock();
+    }
+}
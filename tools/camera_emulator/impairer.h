@@ -0,0 +1,91 @@
+// impairer.h
+// RTP 包级网络损伤：挂在 rtsp-server 媒体的 payloader（pay0）src pad 上的 buffer probe。
+//   - 随机丢包（lossPct）
+//   - 突发丢包：Gilbert-Elliott 两状态，每包以 burstPct 进入突发，突发内全丢，平均持续 burstLen 包
+//   - 抖动：每包额外延迟 [0, jitterMs]，发出顺序保持不变
+//   - 乱序：reorderPct 的包再多延迟 jitterMs+reorderMs，被后续包超过
+//   - 卡顿：每 stallEverySec 秒整体停发 stallMs（包积压后一次性放出，模拟相机/链路冻结）
+// 需要延迟的包在 probe 中取走（DROP），由工作线程到点后 gst_pad_push 到同一 pad 的下游。
+// rtph264pay/rtph265pay 的 FU 分片用 gst_pad_push_list 推送，probe 同时处理 buffer list：
+// 逐包判定，放行的包重组为新 list。
+#pragma once
+
+#include <QtGlobal>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <thread>
+#include <vector>
+
+struct _GstPad;
+struct _GstBuffer;
+struct _GstBufferList;
+
+struct ImpairConfig {
+    double lossPct      = 0.0;
+    double burstPct     = 0.0;
+    int    burstLen     = 10;
+    int    jitterMs     = 0;
+    double reorderPct   = 0.0;
+    int    reorderMs    = 20;
+    int    stallEverySec = 0;
+    int    stallMs      = 0;
+
+    bool delays() const { return jitterMs > 0 || reorderPct > 0.0 || (stallEverySec > 0 && stallMs > 0); }
+    bool any() const    { return lossPct > 0.0 || burstPct > 0.0 || delays(); }
+};
+
+class Impairer
+{
+public:
+    struct Counters {
+        quint64 passed = 0;
+        quint64 lost = 0;
+        quint64 burstLost = 0;
+        quint64 delayed = 0;
+        quint64 reordered = 0;
+    };
+
+    // pad: payloader 的 src pad（持有引用直到析构）
+    Impairer(_GstPad* pad, const ImpairConfig& cfg);
+    ~Impairer();
+
+    Counters counters() const;
+
+private:
+    struct Pending {
+        qint64      releaseUs;
+        quint64     order;
+        _GstBuffer* buf;
+        bool operator>(const Pending& o) const
+        {
+            return releaseUs != o.releaseUs ? releaseUs > o.releaseUs : order > o.order;
+        }
+    };
+
+    // 返回 true = 丢弃/接管（probe 返回 DROP），false = 原样放行
+    bool onBuffer(_GstBuffer* buf);
+    // 逐包 onBuffer；全部放行返回原 list，全部取走返回 nullptr，否则返回放行包组成的新 list
+    _GstBufferList* onBufferList(_GstBufferList* list);
+    void workerLoop();
+
+    _GstPad* pad_ = nullptr;
+    unsigned long probeId_ = 0;
+    const ImpairConfig cfg_;
+
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> uni_{0.0, 1.0};
+    bool    inBurst_ = false;
+    qint64  startUs_ = 0;
+    qint64  lastReleaseUs_ = 0;   // 非乱序包的最晚发出时刻（保持顺序）
+    quint64 order_ = 0;
+
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> queue_;
+    std::thread worker_;
+    bool stop_ = false;
+    Counters counters_;
+};
@@ -0,0 +1,345 @@
+// tools/camera_emulator/main.cpp
+// 本地相机模拟器：代替 YSTech 相机复现现场问题（绿帧、卡顿、"[GST] no samples too long, reconnect"）。
+//   - RTSP：rtsp://127.0.0.1:<port>/<SN>，测试图案（运动）或 MP4 文件，H264/H265
+//   - 心跳：每秒向 <hb-host>:8888 发送 "HB_PING sn=<SN> rtsp_port=<port> rtsp_path=/<SN>"，
+//     本程序 UdpDeviceManager 即可发现设备并按 SN 打开预览
+//   - 子码流（--sub=WxH）：额外挂 /<SN>/sub，心跳改为 rtsp_path=/<SN>,/<SN>/sub（主/子码流双配置）
+//   - 损伤（RTP 包级，见 impairer.h）：丢包、突发丢包、抖动、乱序、周期性卡顿
+//   - 服务端重启：每 restart-every 秒断开所有会话并停止监听 restart-down 秒（期间心跳也停，
+//     与相机重启一致），用来回归测试热重启/全量重建与退避
+//
+// 用法：
+//   camera_emulator [--sn=EMU001[,EMU002...]] [--port=8554] [--hb-host=127.0.0.1] [--hb-port=8888]
+//                   [--source=test|file:/path/a.mp4] [--codec=h264|h265] [--width=1920] [--height=1080]
+//                   [--fps=25] [--gop=25] [--bitrate=4000] [--sub=640x360]
+//                   [--loss=0] [--burst=0] [--burst-len=10] [--jitter=0] [--reorder=0] [--reorder-ms=20]
+//                   [--stall-every=0] [--stall-ms=0] [--restart-every=0] [--restart-down=3]
+// 百分比参数单位为 %，时间参数单位见各选项说明。文件源播完即 EOS（可用来测试 EOS 重连）。
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QHostAddress>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include "impairer.h"
+
+extern "C" {
+#include <gst/gst.h>
+#include <gst/rtsp-server/rtsp-server.h>
+}
+
+struct EmulatorConfig {
+    QStringList sns;
+    int     port = 8554;
+    QString source = "test";
+    bool    h265 = false;
+    int     width = 1920;
+    int     height = 1080;
+    int     fps = 25;
+    int     gop = 25;
+    int     bitrateKbps = 4000;
+    int     subWidth = 0;          // 0 = 不提供子码流
+    int     subHeight = 0;
+    ImpairConfig impair;
+    int     restartEverySec = 0;
+    int     restartDownSec = 3;
+};
+
+// w/h/kbps：主码流用配置值，子码流按面积缩小码率；文件源不转码，子码流与主码流相同
+static QString mediaLaunch(const EmulatorConfig& c, int w, int h, int kbps)
+{
+    const char* pay = c.h265 ? "rtph265pay" : "rtph264pay";
+    if (c.source.startsWith("file:")) {
+        return QString("( filesrc location=\"%1\" ! qtdemux ! %2 ! %3 name=pay0 pt=96 config-interval=-1 )")
+            .arg(c.source.mid(5), c.h265 ? "h265parse" : "h264parse", pay);
+    }
+    // 运动测试图案 + 时间叠加，便于肉眼判断卡顿/花屏
+    return QString("( videotestsrc is-live=true pattern=smpte horizontal-speed=4 "
+                   "! video/x-raw,format=I420,width=%1,height=%2,framerate=%3/1 "
+                   "! timeoverlay font-desc=\"Sans 36\" "
+                   "! %4 tune=zerolatency speed-preset=ultrafast bitrate=%5 key-int-max=%6 "
+                   "! %7 name=pay0 pt=96 config-interval=-1 )")
+        .arg(w).arg(h).arg(c.fps)
+        .arg(c.h265 ? "x265enc" : "x264enc")
+        .arg(kbps)
+        .arg(c.gop)
+        .arg(pay);
+}
+
+// GStreamer / rtsp-server 运行在独立的 GLib 主循环线程（Windows 上 Qt 不用 GLib 事件循环）
+class RtspEmulator
+{
+public:
+    explicit RtspEmulator(const EmulatorConfig& cfg) : cfg_(cfg) {}
+
+    ~RtspEmulator()
+    {
+        if (loop_) {
+            g_main_loop_quit(loop_);
+            if (thread_.joinable()) thread_.join();
+            g_main_loop_unref(loop_);
+        }
+        if (server_) g_object_unref(server_);
+        if (ctx_) g_main_context_unref(ctx_);
+    }
+
+    bool start()
+    {
+        ctx_ = g_main_context_new();
+        loop_ = g_main_loop_new(ctx_, FALSE);
+        server_ = gst_rtsp_server_new();
+        gst_rtsp_server_set_service(server_, QByteArray::number(cfg_.port).constData());
+
+        GstRTSPMountPoints* mounts = gst_rtsp_server_get_mount_points(server_);
+        const QByteArray launch = mediaLaunch(cfg_, cfg_.width, cfg_.height, cfg_.bitrateKbps).toUtf8();
+        QByteArray subLaunch;
+        if (cfg_.subWidth > 0 && cfg_.subHeight > 0) {
+            const double area = double(cfg_.subWidth) * cfg_.subHeight / (double(cfg_.width) * cfg_.height);
+            const int kbps = qMax(200, (int)(cfg_.bitrateKbps * area));
+            subLaunch = mediaLaunch(cfg_, cfg_.subWidth, cfg_.subHeight, kbps).toUtf8();
+        }
+        for (const QString& sn : cfg_.sns) {
+            addFactory(mounts, "/" + sn, launch);
+            if (!subLaunch.isEmpty()) addFactory(mounts, "/" + sn + "/sub", subLaunch);
+        }
+        g_object_unref(mounts);
+
+        if (!attach()) return false;
+        thread_ = std::thread([this]{
+            g_main_context_push_thread_default(ctx_);
+            g_main_loop_run(loop_);
+            g_main_context_pop_thread_default(ctx_);
+        });
+        return true;
+    }
+
+    bool up() const { return up_.load(std::memory_order_acquire); }
+    bool hasSub() const { return cfg_.subWidth > 0 && cfg_.subHeight > 0; }
+
+    // 模拟相机重启：断开所有会话、停止监听；downSec 秒后恢复
+    void restart(int downSec)
+    {
+        g_main_context_invoke(ctx_, [](gpointer self) -> gboolean {
+            static_cast<RtspEmulator*>(self)->goDown();
+            return G_SOURCE_REMOVE;
+        }, this);
+        GSource* t = g_timeout_source_new_seconds((guint)qMax(1, downSec));
+        g_source_set_callback(t, [](gpointer self) -> gboolean {
+            static_cast<RtspEmulator*>(self)->attach();
+            return G_SOURCE_REMOVE;
+        }, this, nullptr);
+        g_source_attach(t, ctx_);
+        g_source_unref(t);
+    }
+
+    Impairer::Counters impairTotals() const
+    {
+        std::lock_guard<std::mutex> lk(impMtx_);
+        Impairer::Counters sum;
+        for (Impairer* i : impairers_) {
+            const Impairer::Counters c = i->counters();
+            sum.passed += c.passed;
+            sum.lost += c.lost;
+            sum.burstLost += c.burstLost;
+            sum.delayed += c.delayed;
+            sum.reordered += c.reordered;
+        }
+        return sum;
+    }
+
+private:
+    void addFactory(GstRTSPMountPoints* mounts, const QString& path, const QByteArray& launch)
+    {
+        GstRTSPMediaFactory* f = gst_rtsp_media_factory_new();
+        gst_rtsp_media_factory_set_launch(f, launch.constData());
+        gst_rtsp_media_factory_set_shared(f, TRUE);
+        if (cfg_.impair.any())
+            g_signal_connect(f, "media-configure", G_CALLBACK(&RtspEmulator::onMediaConfigure), this);
+        gst_rtsp_mount_points_add_factory(mounts, path.toUtf8().constData(), f);
+    }
+
+    bool attach()
+    {
+        sourceId_ = gst_rtsp_server_attach(server_, ctx_);
+        if (sourceId_ == 0) {
+            qWarning().noquote() << QString("[EMU] rtsp server attach failed on port %1").arg(cfg_.port);
+            return false;
+        }
+        up_.store(true, std::memory_order_release);
+        qInfo().noquote() << QString("[EMU] rtsp server up: port %1").arg(cfg_.port);
+        return true;
+    }
+
+    void goDown()
+    {
+        up_.store(false, std::memory_order_release);
+        if (sourceId_) {
+            GSource* s = g_main_context_find_source_by_id(ctx_, sourceId_);
+            if (s) g_source_destroy(s);
+            sourceId_ = 0;
+        }
+        // REMOVE 会关闭客户端连接并拆除其会话
+        gst_rtsp_server_client_filter(server_, [](GstRTSPServer*, GstRTSPClient*, gpointer) {
+            return GST_RTSP_FILTER_REMOVE;
+        }, nullptr);
+        qInfo().noquote() << "[EMU] rtsp server down (simulated restart)";
+    }
+
+    static void onMediaConfigure(GstRTSPMediaFactory*, GstRTSPMedia* media, gpointer self)
+    {
+        auto* emu = static_cast<RtspEmulator*>(self);
+        GstElement* bin = gst_rtsp_media_get_element(media);
+        GstElement* pay = gst_bin_get_by_name(GST_BIN(bin), "pay0");
+        if (pay) {
+            GstPad* src = gst_element_get_static_pad(pay, "src");
+            auto* imp = new Impairer(src, emu->cfg_.impair);
+            gst_object_unref(src);
+            gst_object_unref(pay);
+            {
+                std::lock_guard<std::mutex> lk(emu->impMtx_);
+                emu->impairers_.push_back(imp);
+            }
+            // 媒体销毁时一并释放
+            struct Ctx { RtspEmulator* emu; Impairer* imp; };
+            g_object_set_data_full(G_OBJECT(media), "emu-impairer", new Ctx{ emu, imp }, [](gpointer p) {
+                auto* c = static_cast<Ctx*>(p);
+                {
+                    std::lock_guard<std::mutex> lk(c->emu->impMtx_);
+                    c->emu->impairers_.erase(std::remove(c->emu->impairers_.begin(),
+                                                         c->emu->impairers_.end(), c->imp),
+                                             c->emu->impairers_.end());
+                }
+                delete c->imp;
+                delete c;
+            });
+        }
+        gst_object_unref(bin);
+    }
+
+    const EmulatorConfig cfg_;
+    GMainContext*  ctx_ = nullptr;
+    GMainLoop*     loop_ = nullptr;
+    GstRTSPServer* server_ = nullptr;
+    guint          sourceId_ = 0;
+    std::thread    thread_;
+    std::atomic<bool> up_{false};
+
+    mutable std::mutex impMtx_;
+    std::vector<Impairer*> impairers_;
+};
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    gst_init(&argc, &argv);
+
+    QCommandLineParser p;
+    p.addHelpOption();
+    const QCommandLineOption sn("sn", "camera SN(s), comma separated", "sn", "EMU001");
+    const QCommandLineOption port("port", "RTSP port", "port", "8554");
+    const QCommandLineOption hbHost("hb-host", "heartbeat destination host", "host", "127.0.0.1");
+    const QCommandLineOption hbPort("hb-port", "heartbeat destination port", "port", "8888");
+    const QCommandLineOption source("source", "test | file:/path/to.mp4", "src", "test");
+    const QCommandLineOption codec("codec", "h264 | h265", "codec", "h264");
+    const QCommandLineOption width("width", "test source width", "px", "1920");
+    const QCommandLineOption height("height", "test source height", "px", "1080");
+    const QCommandLineOption fps("fps", "test source frame rate", "fps", "25");
+    const QCommandLineOption gop("gop", "IDR interval (frames); long GOP reproduces pre-IDR green frames", "n", "25");
+    const QCommandLineOption bitrate("bitrate", "test source bitrate (kbps)", "kbps", "4000");
+    const QCommandLineOption sub("sub", "also serve a sub stream WxH at /<SN>/sub", "WxH");
+    const QCommandLineOption loss("loss", "random RTP packet loss (%)", "pct", "0");
+    const QCommandLineOption burst("burst", "chance per packet to start a loss burst (%)", "pct", "0");
+    const QCommandLineOption burstLen("burst-len", "mean burst length (packets)", "n", "10");
+    const QCommandLineOption jitter("jitter", "extra per-packet delay 0..N ms (order kept)", "ms", "0");
+    const QCommandLineOption reorder("reorder", "packets delayed past their successors (%)", "pct", "0");
+    const QCommandLineOption reorderMs("reorder-ms", "extra delay of a reordered packet (ms)", "ms", "20");
+    const QCommandLineOption stallEvery("stall-every", "freeze sending every N seconds", "sec", "0");
+    const QCommandLineOption stallMs("stall-ms", "freeze length (ms)", "ms", "0");
+    const QCommandLineOption restartEvery("restart-every", "simulate a camera restart every N seconds", "sec", "0");
+    const QCommandLineOption restartDown("restart-down", "restart downtime (seconds)", "sec", "3");
+    p.addOptions({ sn, port, hbHost, hbPort, source, codec, width, height, fps, gop, bitrate, sub,
+                   loss, burst, burstLen, jitter, reorder, reorderMs, stallEvery, stallMs,
+                   restartEvery, restartDown });
+    p.process(app);
+
+    EmulatorConfig c;
+    c.sns = p.value(sn).split(',', Qt::SkipEmptyParts);
+    c.port = p.value(port).toInt();
+    c.source = p.value(source);
+    c.h265 = p.value(codec).compare("h265", Qt::CaseInsensitive) == 0;
+    c.width = p.value(width).toInt();
+    c.height = p.value(height).toInt();
+    c.fps = qMax(1, p.value(fps).toInt());
+    c.gop = qMax(1, p.value(gop).toInt());
+    c.bitrateKbps = p.value(bitrate).toInt();
+    if (p.isSet(sub)) {
+        const QStringList wh = p.value(sub).split('x');
+        if (wh.size() == 2) {
+            c.subWidth = wh.at(0).toInt();
+            c.subHeight = wh.at(1).toInt();
+        }
+    }
+    c.impair.lossPct = p.value(loss).toDouble();
+    c.impair.burstPct = p.value(burst).toDouble();
+    c.impair.burstLen = qMax(1, p.value(burstLen).toInt());
+    c.impair.jitterMs = qMax(0, p.value(jitter).toInt());
+    c.impair.reorderPct = p.value(reorder).toDouble();
+    c.impair.reorderMs = qMax(0, p.value(reorderMs).toInt());
+    c.impair.stallEverySec = qMax(0, p.value(stallEvery).toInt());
+    c.impair.stallMs = qMax(0, p.value(stallMs).toInt());
+    c.restartEverySec = qMax(0, p.value(restartEvery).toInt());
+    c.restartDownSec = qMax(1, p.value(restartDown).toInt());
+    if (c.sns.isEmpty()) c.sns << "EMU001";
+
+    RtspEmulator emu(c);
+    if (!emu.start()) return 1;
+
+    for (const QString& s : c.sns) {
+        qInfo().noquote() << QString("[EMU] serving rtsp://127.0.0.1:%1/%2").arg(c.port).arg(s);
+        if (emu.hasSub())
+            qInfo().noquote() << QString("[EMU] serving rtsp://127.0.0.1:%1/%2/sub (%3x%4)")
+                                     .arg(c.port).arg(s).arg(c.subWidth).arg(c.subHeight);
+    }
+
+    // 心跳：服务端“重启”期间停发，与真实相机一致
+    QUdpSocket hb;
+    const QHostAddress hbAddr(p.value(hbHost));
+    const quint16 hbDst = (quint16)p.value(hbPort).toUInt();
+    QTimer hbTimer;
+    QObject::connect(&hbTimer, &QTimer::timeout, [&]{
+        if (!emu.up()) return;
+        for (const QString& s : c.sns) {
+            const QString paths = emu.hasSub() ? QString("/%1,/%1/sub").arg(s) : "/" + s;
+            const QByteArray msg = QString("HB_PING sn=%1 rtsp_port=%2 rtsp_path=%3")
+                                       .arg(s).arg(c.port).arg(paths).toUtf8();
+            hb.writeDatagram(msg, hbAddr, hbDst);
+        }
+    });
+    hbTimer.start(1000);
+
+    QTimer restartTimer;
+    if (c.restartEverySec > 0) {
+        QObject::connect(&restartTimer, &QTimer::timeout, [&]{ emu.restart(c.restartDownSec); });
+        restartTimer.start(c.restartEverySec * 1000);
+    }
+
+    QTimer statTimer;
+    if (c.impair.any()) {
+        QObject::connect(&statTimer, &QTimer::timeout, [&]{
+            const Impairer::Counters t = emu.impairTotals();
+            qInfo().noquote() << QString("[EMU] rtp passed=%1 lost=%2 burstLost=%3 delayed=%4 reordered=%5")
+                                     .arg(t.passed).arg(t.lost).arg(t.burstLost)
+                                     .arg(t.delayed).arg(t.reordered);
+        });
+        statTimer.start(10000);
+    }
+
+    return app.exec();
+}
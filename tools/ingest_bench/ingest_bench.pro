@@ -0,0 +1,38 @@
+# 离线拉流基准（无头，无需相机/GPU，Linux 下用 pkg-config 找 GStreamer）
+#   qmake tools/ingest_bench/ingest_bench.pro && make
+#   ./ingest_bench --duration=30 --out=result.json
+QT = core
+CONFIG += c++17 console
+CONFIG -= app_bundle
+TARGET = ingest_bench
+
+INCLUDEPATH += $$PWD/../..
+
+SOURCES += \
+    main.cpp \
+    $$PWD/../../ingestpipeline.cpp \
+    $$PWD/../../latencyhistogram.cpp
+
+HEADERS += \
+    $$PWD/../../ingestpipeline.h \
+    $$PWD/../../latencyhistogram.h
+
+unix {
+    CONFIG += link_pkgconfig
+    PKGCONFIG += gstreamer-1.0 gstreamer-app-1.0 gstreamer-video-1.0
+}
+
+win32 {
+    QMAKE_CXXFLAGS += -utf-8
+    GST_ROOT = E:/ThirdParty/Gstreamer/1.0/msvc_x86_64
+    INCLUDEPATH += \
+        $$GST_ROOT/include/gstreamer-1.0 \
+        $$GST_ROOT/include/glib-2.0 \
+        $$GST_ROOT/lib/glib-2.0/include
+    LIBS += \
+        "$$GST_ROOT/lib/gstreamer-1.0.lib" \
+        "$$GST_ROOT/lib/gstapp-1.0.lib" \
+        "$$GST_ROOT/lib/gstvideo-1.0.lib" \
+        "$$GST_ROOT/lib/glib-2.0.lib" \
+        "$$GST_ROOT/lib/gobject-2.0.lib"
+}
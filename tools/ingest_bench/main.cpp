@@ -0,0 +1,501 @@
+// tools/ingest_bench/main.cpp
+// 离线拉流基准（无头，不需要相机和 GPU）。
+// 发送端（子进程）：videotestsrc 或 MP4 文件 → x264enc/x265enc → rtph26Xpay → udpsink 127.0.0.1；
+// 接收端（本进程）：与 RtspViewerQt 完全相同的管线构造（ingestpipeline.h），
+// 只把 rtspsrc 源片段换成 udpsrc ! rtpjitterbuffer。取帧/拷贝方式同 RtspViewerQt 的 copy 模式。
+// 预热后计时固定时长，结果以 JSON 输出：fps、拷贝耗时、帧间隔分位、每帧 CPU、每帧堆分配次数。
+//
+// 用法：
+//   ingest_bench [--duration=30] [--warmup=3] [--codec=h264|h265] [--decoder=avdec_h264]
+//                [--source=test|file:/path/a.mp4] [--width=1920] [--height=1080] [--fps=25]
+//                [--bitrate=4000] [--latency=150] [--threads=0] [--preview-width=0]
+//                [--full-res] [--yuv] [--port=5600] [--out=result.json]
+//
+// 每帧 CPU 为接收进程（不含发送子进程）user+sys 时间；堆分配用全局 operator new
+// 与 glibc malloc 计数（其他平台只有 operator new）。文件源需长于 warmup+duration。
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "ingestpipeline.h"
+#include "latencyhistogram.h"
+
+extern "C" {
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+#include <gst/video/video.h>
+}
+
+// ---------------------------------------------------------------------------
+// 堆分配计数（所有线程，含 GStreamer 内部）
+
+static std::atomic<quint64> g_news{0};
+static std::atomic<quint64> g_mallocs{0};
+
+void* operator new(std::size_t n)
+{
+    g_news.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1)) return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return operator new(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept
+{
+    g_news.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(n ? n : 1);
+}
+void* operator new[](std::size_t n, const std::nothrow_t& t) noexcept { return operator new(n, t); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+#if defined(__GLIBC__)
+// glibc 允许可执行文件覆盖 malloc 族；memalign 系列仍走 glibc 内部，释放经由这里的 free 也正确
+extern "C" {
+void* __libc_malloc(size_t);
+void* __libc_calloc(size_t, size_t);
+void* __libc_realloc(void*, size_t);
+void  __libc_free(void*);
+
+void* malloc(size_t n)
+{
+    g_mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(n);
+}
+void* calloc(size_t n, size_t sz)
+{
+    g_mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_calloc(n, sz);
+}
+void* realloc(void* p, size_t n)
+{
+    g_mallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_realloc(p, n);
+}
+void free(void* p) { __libc_free(p); }
+}
+static constexpr bool kCountsMalloc = true;
+#else
+static constexpr bool kCountsMalloc = false;
+#endif
+
+// ---------------------------------------------------------------------------
+
+static qint64 monotonicUs()
+{
+    using namespace std::chrono;
+    return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
+// 本进程 user+sys CPU 时间（us）
+static qint64 processCpuUs()
+{
+#ifdef Q_OS_WIN
+    FILETIME c, e, k, u;
+    if (!GetProcessTimes(GetCurrentProcess(), &c, &e, &k, &u)) return 0;
+    const quint64 kt = ((quint64)k.dwHighDateTime << 32) | k.dwLowDateTime;
+    const quint64 ut = ((quint64)u.dwHighDateTime << 32) | u.dwLowDateTime;
+    return (qint64)((kt + ut) / 10);
+#else
+    rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return (qint64)(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000
+           + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec;
+#endif
+}
+
+static QJsonObject summaryJson(const LatencyHistogram& h)
+{
+    const LatencySummary s = h.summary();
+    return QJsonObject{
+        { "count", (double)s.count },
+        { "p50", s.p50Ms }, { "p90", s.p90Ms }, { "p99", s.p99Ms },
+        { "max", s.maxMs }, { "avg", s.avgMs },
+    };
+}
+
+struct Options {
+    int     durationSec  = 30;
+    int     warmupSec    = 3;
+    VideoCodec codec     = VideoCodec::H264;
+    QString decoder;
+    QString source       = "test";
+    int     width        = 1920;
+    int     height       = 1080;
+    int     fps          = 25;
+    int     bitrateKbps  = 4000;
+    int     latencyMs    = 150;
+    int     threads      = 0;
+    int     previewWidth = 0;
+    bool    fullRes      = false;
+    bool    yuv          = false;
+    int     port         = 5600;
+    QString out;
+};
+
+// ---------------------------------------------------------------------------
+// 发送端
+
+static QString senderPipeline(const Options& o)
+{
+    const bool h265 = o.codec == VideoCodec::H265;
+    QString enc;
+    if (o.source.startsWith("file:")) {
+        enc = QString("filesrc location=\"%1\" ! qtdemux ! %2 ")
+                  .arg(o.source.mid(5), h265 ? "h265parse" : "h264parse");
+    } else {
+        // 运动画面：解码负载接近真实场景
+        enc = QString("videotestsrc is-live=true pattern=smpte horizontal-speed=4 "
+                      "! video/x-raw,format=I420,width=%1,height=%2,framerate=%3/1 "
+                      "! %4 tune=zerolatency speed-preset=ultrafast bitrate=%5 key-int-max=%3 ")
+                  .arg(o.width).arg(o.height).arg(o.fps)
+                  .arg(h265 ? "x265enc" : "x264enc")
+                  .arg(o.bitrateKbps);
+    }
+    return enc + QString("! %1 config-interval=-1 pt=96 mtu=1400 "
+                         "! udpsink host=127.0.0.1 port=%2 sync=true")
+                     .arg(h265 ? "rtph265pay" : "rtph264pay")
+                     .arg(o.port);
+}
+
+static int runSender(const Options& o)
+{
+    const QString desc = senderPipeline(o);
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(desc.toUtf8().constData(), &err);
+    if (!pipeline) {
+        fprintf(stderr, "[SENDER] parse_launch failed: %s\n", err ? err->message : "unknown");
+        if (err) g_error_free(err);
+        return 2;
+    }
+    if (err) g_error_free(err);
+
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+    GstBus* bus = gst_element_get_bus(pipeline);
+    const GstClockTime runNs = (GstClockTime)(o.warmupSec + o.durationSec + 5) * GST_SECOND;
+    GstMessage* msg = gst_bus_timed_pop_filtered(bus, runNs,
+                                                 (GstMessageType)(GST_MESSAGE_ERROR | GST_MESSAGE_EOS));
+    int rc = 0;
+    if (msg && GST_MESSAGE_TYPE(msg) == GST_MESSAGE_ERROR) {
+        GError* e = nullptr;
+        gst_message_parse_error(msg, &e, nullptr);
+        fprintf(stderr, "[SENDER] error: %s\n", e ? e->message : "");
+        if (e) g_error_free(e);
+        rc = 3;
+    }
+    if (msg) gst_message_unref(msg);
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(pipeline);
+    return rc;
+}
+
+// ---------------------------------------------------------------------------
+// 接收端
+
+static std::atomic<quint64> g_encodedFrames{0};
+static std::atomic<quint64> g_fullFrames{0};
+static std::atomic<quint64> g_yuvFrames{0};
+
+static void drainSink(GstElement* pipeline, const char* name, std::atomic<quint64>* counter)
+{
+    GstElement* e = gst_bin_get_by_name(GST_BIN(pipeline), name);
+    if (!e) return;
+    GstAppSinkCallbacks cbs = {};
+    cbs.new_sample = [](GstAppSink* s, gpointer c) -> GstFlowReturn {
+        if (GstSample* sample = gst_app_sink_pull_sample(s)) {
+            static_cast<std::atomic<quint64>*>(c)->fetch_add(1, std::memory_order_relaxed);
+            gst_sample_unref(sample);
+        }
+        return GST_FLOW_OK;
+    };
+    gst_app_sink_set_callbacks(GST_APP_SINK(e), &cbs, counter, nullptr);
+    gst_object_unref(e);
+}
+
+static void openValve(GstElement* pipeline, const char* name)
+{
+    if (GstElement* v = gst_bin_get_by_name(GST_BIN(pipeline), name)) {
+        g_object_set(v, "drop", FALSE, NULL);
+        gst_object_unref(v);
+    }
+}
+
+static void readJitterBuffer(GstElement* pipeline, QJsonObject* out)
+{
+    GstElement* jb = gst_bin_get_by_name(GST_BIN(pipeline), "jb");
+    if (!jb) return;
+    GstStructure* st = nullptr;
+    g_object_get(jb, "stats", &st, NULL);
+    if (st) {
+        guint64 pushed = 0, lost = 0, late = 0;
+        gst_structure_get_uint64(st, "num-pushed", &pushed);
+        gst_structure_get_uint64(st, "num-lost", &lost);
+        gst_structure_get_uint64(st, "num-late", &late);
+        out->insert("jbPushed", (double)pushed);
+        out->insert("jbLost", (double)lost);
+        out->insert("jbLate", (double)late);
+        gst_structure_free(st);
+    }
+    gst_object_unref(jb);
+}
+
+static int runReceiver(const Options& o)
+{
+    const CodecChain& cc = codec_chain(o.codec);
+    const DecoderCandidate* dec = o.decoder.isEmpty()
+                                      ? best_decoder(cc)
+                                      : find_decoder(cc, o.decoder.toLatin1().constData());
+    if (!dec) {
+        fprintf(stderr, "[BENCH] no usable decoder for %s%s\n", codec_name(o.codec),
+                o.decoder.isEmpty() ? "" : qPrintable(" (" + o.decoder + ")"));
+        return 2;
+    }
+
+    const QString source =
+        QString("udpsrc name=src port=%1 buffer-size=%2 "
+                "caps=\"application/x-rtp,media=video,clock-rate=90000,encoding-name=%3,payload=96\" "
+                "! rtpjitterbuffer name=jb latency=%4 drop-on-latency=true ! ")
+            .arg(o.port)
+            .arg(kUdpRcvBufBytes)
+            .arg(cc.encodingName)
+            .arg(o.latencyMs);
+    const QString desc = build_ingest_pipeline(source, cc, *dec, o.threads);
+
+    GError* err = nullptr;
+    GstElement* pipeline = gst_parse_launch(desc.toUtf8().constData(), &err);
+    if (!pipeline) {
+        fprintf(stderr, "[BENCH] parse_launch failed: %s\n", err ? err->message : "unknown");
+        if (err) g_error_free(err);
+        return 2;
+    }
+    if (err) g_error_free(err);
+
+    GstElement* sinkElem = gst_bin_get_by_name(GST_BIN(pipeline), "sink");
+    GstAppSink* appsink = GST_APP_SINK(sinkElem);
+    drainSink(pipeline, "esink", &g_encodedFrames);
+    drainSink(pipeline, "fullsink", &g_fullFrames);
+    drainSink(pipeline, "yuvsink", &g_yuvFrames);
+    if (o.fullRes) openValve(pipeline, "fullvalve");
+    if (o.yuv)     openValve(pipeline, "yuvvalve");
+    const bool testSource = !o.source.startsWith("file:");
+    if (o.previewWidth > 0) {
+        if (GstElement* pv = gst_bin_get_by_name(GST_BIN(pipeline), "pvcaps")) {
+            // 文件源尺寸未知：只给宽度，由缩放元素保持宽高比
+            apply_preview_width(pv, o.previewWidth, testSource ? o.width : 0, testSource ? o.height : 0);
+            gst_object_unref(pv);
+        }
+    }
+
+    // 先让 udpsrc 绑定端口，再启动发送端（独立子进程，CPU 不计入本进程）
+    gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+    QProcess sender;
+    QStringList args = QCoreApplication::arguments().mid(1);
+    args << "--role=sender";
+    sender.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    sender.start(QCoreApplication::applicationFilePath(), args);
+
+    LatencyHistogram gapHist, copyHist;
+    std::vector<uchar> frameBuf;
+    quint64 frames = 0;
+    qint64  lastSampleUs = -1;
+    int     outW = 0, outH = 0;
+
+    const qint64 t0 = monotonicUs();
+    const qint64 measureStartUs = t0 + (qint64)o.warmupSec * 1000000;
+    const qint64 endUs = measureStartUs + (qint64)o.durationSec * 1000000;
+    bool measuring = false;
+    qint64 cpu0 = 0;
+    quint64 news0 = 0, mallocs0 = 0, full0 = 0, yuv0 = 0;
+    const GstClockTime pullTimeout = 40 * GST_MSECOND;
+
+    GstBus* bus = gst_element_get_bus(pipeline);
+    QString error;
+
+    while (true) {
+        const qint64 now = monotonicUs();
+        if (now >= endUs) break;
+        if (!measuring && now >= measureStartUs) {
+            // 预热结束：计数器与直方图从这里开始
+            measuring = true;
+            gapHist.reset();
+            copyHist.reset();
+            frames = 0;
+            lastSampleUs = -1;
+            cpu0 = processCpuUs();
+            news0 = g_news.load(std::memory_order_relaxed);
+            mallocs0 = g_mallocs.load(std::memory_order_relaxed);
+            full0 = g_fullFrames.load(std::memory_order_relaxed);
+            yuv0 = g_yuvFrames.load(std::memory_order_relaxed);
+        }
+
+        if (GstMessage* msg = gst_bus_pop_filtered(bus, GST_MESSAGE_ERROR)) {
+            GError* e = nullptr;
+            gst_message_parse_error(msg, &e, nullptr);
+            error = QString::fromUtf8(e ? e->message : "");
+            if (e) g_error_free(e);
+            gst_message_unref(msg);
+            break;
+        }
+
+        GstSample* sample = gst_app_sink_try_pull_sample(appsink, pullTimeout);
+        if (!sample) continue;
+
+        const qint64 arriveUs = monotonicUs();
+        if (lastSampleUs >= 0) gapHist.record(arriveUs - lastSampleUs);
+        lastSampleUs = arriveUs;
+
+        GstCaps* caps = gst_sample_get_caps(sample);
+        GstBuffer* buffer = gst_sample_get_buffer(sample);
+        GstVideoInfo vinfo;
+        if (caps && buffer && gst_video_info_from_caps(&vinfo, caps)) {
+            outW = (int)GST_VIDEO_INFO_WIDTH(&vinfo);
+            outH = (int)GST_VIDEO_INFO_HEIGHT(&vinfo);
+            const int srcStride = (int)GST_VIDEO_INFO_PLANE_STRIDE(&vinfo, 0);
+            const int rowBytes = outW * 4;
+            const qint64 tc = monotonicUs();
+            GstMapInfo map;
+            if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+                // 同 RtspViewerQt copy 模式：复用目标缓冲，逐行拷贝
+                const size_t need = (size_t)rowBytes * (size_t)outH;
+                if (frameBuf.size() != need) frameBuf.resize(need);
+                const uchar* src = map.data;
+                if (srcStride == rowBytes) {
+                    memcpy(frameBuf.data(), src, need);
+                } else {
+                    for (int y = 0; y < outH; ++y)
+                        memcpy(frameBuf.data() + (size_t)y * rowBytes, src + (size_t)y * srcStride, rowBytes);
+                }
+                gst_buffer_unmap(buffer, &map);
+                copyHist.record(monotonicUs() - tc);
+            }
+        }
+        gst_sample_unref(sample);
+        ++frames;
+    }
+
+    const qint64 cpuUs = measuring ? processCpuUs() - cpu0 : 0;
+    const quint64 news = g_news.load(std::memory_order_relaxed) - news0;
+    const quint64 mallocs = g_mallocs.load(std::memory_order_relaxed) - mallocs0;
+    const double  measuredSec = measuring ? (monotonicUs() - measureStartUs) / 1e6 : 0.0;
+
+    QJsonObject r;
+    r.insert("codec", codec_name(o.codec));
+    r.insert("decoder", dec->tag);
+    r.insert("source", o.source);
+    if (testSource) {
+        r.insert("sourceWidth", o.width);
+        r.insert("sourceHeight", o.height);
+    }
+    r.insert("outputWidth", outW);
+    r.insert("outputHeight", outH);
+    r.insert("latencyMs", o.latencyMs);
+    r.insert("fullRes", o.fullRes);
+    r.insert("yuv", o.yuv);
+    r.insert("durationSec", measuredSec);
+    r.insert("frames", (double)frames);
+    r.insert("fps", measuredSec > 0 ? frames / measuredSec : 0.0);
+    r.insert("expectedFps", o.fps);
+    r.insert("fullResFrames", (double)(g_fullFrames.load() - full0));
+    r.insert("yuvFrames", (double)(g_yuvFrames.load() - yuv0));
+    r.insert("gapMs", summaryJson(gapHist));
+    r.insert("copyMs", summaryJson(copyHist));
+    r.insert("cpuMsPerFrame", frames ? cpuUs / 1000.0 / frames : 0.0);
+    r.insert("cpuCores", measuredSec > 0 ? cpuUs / 1e6 / measuredSec : 0.0);
+    r.insert("newPerFrame", frames ? (double)news / frames : 0.0);
+    if (kCountsMalloc) r.insert("mallocPerFrame", frames ? (double)mallocs / frames : 0.0);
+    readJitterBuffer(pipeline, &r);
+    if (!error.isEmpty()) r.insert("error", error);
+
+    gst_object_unref(bus);
+    gst_element_set_state(pipeline, GST_STATE_NULL);
+    gst_object_unref(sinkElem);
+    gst_object_unref(pipeline);
+
+    sender.terminate();
+    if (!sender.waitForFinished(2000)) sender.kill();
+
+    const QByteArray json = QJsonDocument(r).toJson(QJsonDocument::Indented);
+    if (o.out.isEmpty()) {
+        fwrite(json.constData(), 1, json.size(), stdout);
+    } else {
+        QFile f(o.out);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            fprintf(stderr, "[BENCH] cannot write %s\n", qPrintable(o.out));
+            return 2;
+        }
+        f.write(json);
+    }
+    return (frames > 0 && error.isEmpty()) ? 0 : 1;
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    gst_init(&argc, &argv);
+
+    QCommandLineParser p;
+    p.addHelpOption();
+    const QCommandLineOption role("role", "sender | receiver (internal)", "role", "receiver");
+    const QCommandLineOption duration("duration", "measured seconds", "sec", "30");
+    const QCommandLineOption warmup("warmup", "warmup seconds (not measured)", "sec", "3");
+    const QCommandLineOption codec("codec", "h264 | h265", "codec", "h264");
+    const QCommandLineOption decoder("decoder", "decoder factory, e.g. avdec_h264 (default: best available)", "name");
+    const QCommandLineOption source("source", "test | file:/path/to.mp4", "src", "test");
+    const QCommandLineOption width("width", "test source width", "px", "1920");
+    const QCommandLineOption height("height", "test source height", "px", "1080");
+    const QCommandLineOption fps("fps", "test source frame rate", "fps", "25");
+    const QCommandLineOption bitrate("bitrate", "test source bitrate (kbps)", "kbps", "4000");
+    const QCommandLineOption latency("latency", "rtpjitterbuffer latency (ms)", "ms", "150");
+    const QCommandLineOption threads("threads", "software decoder max-threads (0 = auto)", "n", "0");
+    const QCommandLineOption previewWidth("preview-width", "preview branch width (0 = source)", "px", "0");
+    const QCommandLineOption fullRes("full-res", "open the full-resolution branch");
+    const QCommandLineOption yuv("yuv", "open the planar YUV branch");
+    const QCommandLineOption port("port", "loopback UDP port", "port", "5600");
+    const QCommandLineOption out("out", "write JSON here instead of stdout", "file");
+    p.addOptions({ role, duration, warmup, codec, decoder, source, width, height, fps, bitrate,
+                   latency, threads, previewWidth, fullRes, yuv, port, out });
+    p.process(app);
+
+    Options o;
+    o.durationSec  = qMax(1, p.value(duration).toInt());
+    o.warmupSec    = qMax(0, p.value(warmup).toInt());
+    o.codec        = p.value(codec).compare("h265", Qt::CaseInsensitive) == 0 ? VideoCodec::H265 : VideoCodec::H264;
+    o.decoder      = p.value(decoder);
+    o.source       = p.value(source);
+    o.width        = p.value(width).toInt();
+    o.height       = p.value(height).toInt();
+    o.fps          = qMax(1, p.value(fps).toInt());
+    o.bitrateKbps  = p.value(bitrate).toInt();
+    o.latencyMs    = p.value(latency).toInt();
+    o.threads      = p.value(threads).toInt();
+    o.previewWidth = p.value(previewWidth).toInt();
+    o.fullRes      = p.isSet(fullRes);
+    o.yuv          = p.isSet(yuv);
+    o.port         = p.value(port).toInt();
+    o.out          = p.value(out);
+
+    return p.value(role) == "sender" ? runSender(o) : runReceiver(o);
+}
@@ -33,6 +33,8 @@
     <message><source>开</source><translation>ON</translation></message>
     <message><source>关</source><translation>OFF</translation></message>
     <message><source>触发模式: %1</source><translation>Trigger mode: %1</translation></message>
+    <message><source>主码流未能在 %1 秒内出画，录像未开始。请检查相机主码流地址或并发会话数限制。</source><translation>The main stream did not deliver a frame within %1 s; recording was not started. Check the camera's main stream path or its concurrent session limit.</translation></message>
+    <message><source>录像失败</source><translation>Recording Failed</translation></message>
 </context>
 <context>
     <name>ThemedMessageDialog</name>
@@ -52,6 +54,8 @@
     <message><source>录像格式</source><translation>Recording Format</translation></message>
     <message><source>录像叠加信息</source><translation>Recording Overlay</translation></message>
     <message><source>录像/截图时保存叠加时间信息</source><translation>Save overlay time info when recording/capturing</translation></message>
+    <message><source>直通录像</source><translation>Passthrough Recording</translation></message>
+    <message><source>保存相机原始码流（叠加信息写入文件元数据）</source><translation>Save the camera's original stream (overlay info written to file metadata)</translation></message>
     <message><source>界面语言</source><translation>Language</translation></message>
     <message><source>确定</source><translation>OK</translation></message>
     <message><source>取消</source><translation>Cancel</translation></message>
@@ -77,6 +81,12 @@
     <message><source>系统日志</source><translation>System Log</translation></message>
     <message><source>分辨率</source><translation>Resolution</translation></message>
     <message><source>帧率</source><translation>Frame Rate</translation></message>
+    <message><source>网络丢包</source><translation>Network Loss</translation></message>
+    <message><source>缓冲丢包</source><translation>Buffer Loss</translation></message>
+    <message><source>迟到</source><translation>Late</translation></message>
+    <message><source>重复包</source><translation>Duplicates</translation></message>
+    <message><source>网络抖动</source><translation>Network Jitter</translation></message>
+    <message><source>帧池丢帧</source><translation>Pool Drops</translation></message>
     <message><source>LED灯</source><translation>LED Light</translation></message>
     <message><source>硬件触发</source><translation>Hardware Trigger</translation></message>
     <message><source>当前：硬件触发</source><translation>Current: Hardware Trigger</translation></message>
@@ -33,6 +33,8 @@
     <message><source>开</source><translation>켜짐</translation></message>
     <message><source>关</source><translation>꺼짐</translation></message>
     <message><source>触发模式: %1</source><translation>트리거 모드: %1</translation></message>
+    <message><source>主码流未能在 %1 秒内出画，录像未开始。请检查相机主码流地址或并发会话数限制。</source><translation>메인 스트림이 %1초 안에 영상을 보내지 않아 녹화를 시작하지 않았습니다. 카메라 메인 스트림 경로 또는 동시 세션 수 제한을 확인하세요.</translation></message>
+    <message><source>录像失败</source><translation>녹화 실패</translation></message>
 </context>
 <context>
     <name>ThemedMessageDialog</name>
@@ -52,6 +54,8 @@
     <message><source>录像格式</source><translation>녹화 형식</translation></message>
     <message><source>录像叠加信息</source><translation>녹화 오버레이</translation></message>
     <message><source>录像/截图时保存叠加时间信息</source><translation>녹화/캡처 시 오버레이 시간 정보 저장</translation></message>
+    <message><source>直通录像</source><translation>패스스루 녹화</translation></message>
+    <message><source>保存相机原始码流（叠加信息写入文件元数据）</source><translation>카메라 원본 스트림 저장 (오버레이 정보는 파일 메타데이터에 기록)</translation></message>
     <message><source>界面语言</source><translation>언어</translation></message>
     <message><source>确定</source><translation>확인</translation></message>
     <message><source>取消</source><translation>취소</translation></message>
@@ -82,6 +86,12 @@
     <message><source>系统日志</source><translation>시스템 로그</translation></message>
     <message><source>分辨率</source><translation>해상도</translation></message>
     <message><source>帧率</source><translation>프레임 속도</translation></message>
+    <message><source>网络丢包</source><translation>네트워크 손실</translation></message>
+    <message><source>缓冲丢包</source><translation>버퍼 손실</translation></message>
+    <message><source>迟到</source><translation>지연 도착</translation></message>
+    <message><source>重复包</source><translation>중복 패킷</translation></message>
+    <message><source>网络抖动</source><translation>네트워크 지터</translation></message>
+    <message><source>帧池丢帧</source><translation>프레임 풀 드롭</translation></message>
     <message><source>视频显示区</source><translation>비디오 영역</translation></message>
     <message><source>系统状态</source><translation>시스템 상태</translation></message>
     <message><source>录像状态</source><translation>녹화 상태</translation></message>
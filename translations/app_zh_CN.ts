@@ -33,6 +33,8 @@
     <message><source>开</source><translation>开</translation></message>
     <message><source>关</source><translation>关</translation></message>
     <message><source>触发模式: %1</source><translation>触发模式: %1</translation></message>
+    <message><source>主码流未能在 %1 秒内出画，录像未开始。请检查相机主码流地址或并发会话数限制。</source><translation>主码流未能在 %1 秒内出画，录像未开始。请检查相机主码流地址或并发会话数限制。</translation></message>
+    <message><source>录像失败</source><translation>录像失败</translation></message>
 </context>
 <context>
     <name>ThemedMessageDialog</name>
@@ -52,6 +54,8 @@
     <message><source>录像格式</source><translation>录像格式</translation></message>
     <message><source>录像叠加信息</source><translation>录像叠加信息</translation></message>
     <message><source>录像/截图时保存叠加时间信息</source><translation>录像/截图时保存叠加时间信息</translation></message>
+    <message><source>直通录像</source><translation>直通录像</translation></message>
+    <message><source>保存相机原始码流（叠加信息写入文件元数据）</source><translation>保存相机原始码流（叠加信息写入文件元数据）</translation></message>
     <message><source>界面语言</source><translation>界面语言</translation></message>
     <message><source>确定</source><translation>确定</translation></message>
     <message><source>取消</source><translation>取消</translation></message>
@@ -83,6 +87,12 @@
     <message><source>系统日志</source><translation>系统日志</translation></message>
     <message><source>分辨率</source><translation>分辨率</translation></message>
     <message><source>帧率</source><translation>帧率</translation></message>
+    <message><source>网络丢包</source><translation>网络丢包</translation></message>
+    <message><source>缓冲丢包</source><translation>缓冲丢包</translation></message>
+    <message><source>迟到</source><translation>迟到</translation></message>
+    <message><source>重复包</source><translation>重复包</translation></message>
+    <message><source>网络抖动</source><translation>网络抖动</translation></message>
+    <message><source>帧池丢帧</source><translation>帧池丢帧</translation></message>
 </context>
 <context>
     <name>TopToolBar</name>
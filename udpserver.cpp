@@ -18,6 +18,14 @@ static QString parseRtspPath(const QString& msg){
     return m.hasMatch() ? m.captured(1).trimmed() : QString();
 }
 
+// 子码流：rtsp_sub_path=/xxx，或 rtsp_path=/main,/sub（逗号后为子码流）
+static QString parseRtspSubPath(const QString& msg){
+    static QRegularExpression re(R"(rtsp_sub_path\s*=\s*([^\s]+))",
+                                 QRegularExpression::CaseInsensitiveOption);
+    const QRegularExpressionMatch m = re.match(msg);
+    return m.hasMatch() ? m.captured(1).trimmed() : QString();
+}
+
 static int parseRtspPort(const QString& msg){
     static QRegularExpression re(R"(rtsp_port\s*=\s*(\d+))",
                                  QRegularExpression::CaseInsensitiveOption);
@@ -265,15 +273,22 @@ void UdpDeviceManager::upsertDevice(const QString& sn,
         // parse rtsp endpoint if present
         const int rp = parseRtspPort(rawMsg);
         const QString rpath = parseRtspPath(rawMsg);
+        const QStringList rpaths = rpath.split(',');
+        QString subPath = parseRtspSubPath(rawMsg);
+        if (subPath.isEmpty() && rpaths.size() > 1) subPath = rpaths.at(1).trimmed();
 
         if (rp > 0 && rp <= 65535) d.rtspPort = (quint16)rp;
-        if (!rpath.isEmpty()) d.rtspPath = rpath;
+        if (!rpath.isEmpty()) {
+            d.rtspPath = rpaths.at(0).trimmed();
+            d.rtspSubPath = subPath;   // 只在声明了路径的心跳里更新，旧固件不带子码流即清空
+        }
 
-        log = QString("[UDP-Mgr] device map: SN=%1 -> %2:%3 rtsp=%4%5")
+        log = QString("[UDP-Mgr] device map: SN=%1 -> %2:%3 rtsp=%4%5%6")
                   .arg(sn)
                   .arg(ip.toString()).arg(srcPort)
                   .arg(d.rtspPort)
-                  .arg(d.rtspPath);
+                  .arg(d.rtspPath)
+                  .arg(d.rtspSubPath.isEmpty() ? QString() : " sub=" + d.rtspSubPath);
     }
 
     // emit OUTSIDE lock (avoid deadlock)
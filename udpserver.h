@@ -19,7 +19,8 @@ struct DeviceInfo {
 
     // RTSP endpoint (from msg)
     quint16 rtspPort = 8554;
-    QString rtspPath;              // e.g. "/YSTech-TURBIDCAM-0001"
+    QString rtspPath;              // e.g. "/YSTech-TURBIDCAM-0001"（主码流）
+    QString rtspSubPath;           // 子码流，空 = 相机只有一路码流
 };
 
 class UdpDeviceManager : public QObject {
@@ -17,6 +17,14 @@ class UiController : public QObject
     Q_PROPERTY(bool     deviceOnline       READ deviceOnline       NOTIFY deviceOnlineChanged)
     Q_PROPERTY(int      currentFps         READ currentFps         NOTIFY currentFpsChanged)
     Q_PROPERTY(QString  resolution         READ resolution         NOTIFY resolutionChanged)
+    // RTP 接收统计（每秒速率，来自 RtspViewerQt::streamStats()）：网络丢包（rtpsession，jitterbuffer 之前）
+    // 与 jitterbuffer 丢包分开显示，帧池丢帧（累计）用来区分网络问题与本机解码/消费跟不上
+    Q_PROPERTY(double   rtpNetLostPerSec   READ rtpNetLostPerSec   NOTIFY rtpStatsChanged)
+    Q_PROPERTY(double   rtpLostPerSec      READ rtpLostPerSec      NOTIFY rtpStatsChanged)
+    Q_PROPERTY(double   rtpLatePerSec      READ rtpLatePerSec      NOTIFY rtpStatsChanged)
+    Q_PROPERTY(double   rtpDupPerSec       READ rtpDupPerSec       NOTIFY rtpStatsChanged)
+    Q_PROPERTY(double   rtpJitterMs        READ rtpJitterMs        NOTIFY rtpStatsChanged)
+    Q_PROPERTY(double   framePoolDrops     READ framePoolDrops     NOTIFY rtpStatsChanged)
     Q_PROPERTY(bool     recording          READ recording          NOTIFY recordingChanged)
     Q_PROPERTY(QString  recordFileName     READ recordFileName     NOTIFY recordFileNameChanged)
     Q_PROPERTY(int      recordSegmentIndex READ recordSegmentIndex NOTIFY recordSegmentIndexChanged)
@@ -52,6 +60,12 @@ public:
     bool        deviceOnline()         const { return deviceOnline_; }
     int         currentFps()           const { return currentFps_; }
     QString     resolution()           const { return resolution_; }
+    double      rtpNetLostPerSec()     const { return rtpNetLostPerSec_; }
+    double      rtpLostPerSec()        const { return rtpLostPerSec_; }
+    double      rtpLatePerSec()        const { return rtpLatePerSec_; }
+    double      rtpDupPerSec()         const { return rtpDupPerSec_; }
+    double      rtpJitterMs()          const { return rtpJitterMs_; }
+    double      framePoolDrops()       const { return framePoolDrops_; }
     bool        recording()            const { return recording_; }
     QString     recordFileName()       const { return recordFileName_; }
     int         recordSegmentIndex()   const { return recordSegmentIndex_; }
@@ -82,6 +96,15 @@ public slots:
     void setDeviceOnline(bool v)            { if (deviceOnline_ == v) return; deviceOnline_ = v; emit deviceOnlineChanged(); }
     void setCurrentFps(int v)               { if (currentFps_ == v) return; currentFps_ = v; emit currentFpsChanged(); }
     void setResolution(const QString& v)    { if (resolution_ == v) return; resolution_ = v; emit resolutionChanged(); }
+    void setRtpStats(double netLostPerSec, double lostPerSec, double latePerSec, double dupPerSec,
+                     double jitterMs, double poolDrops) {
+        if (rtpNetLostPerSec_ == netLostPerSec && rtpLostPerSec_ == lostPerSec && rtpLatePerSec_ == latePerSec
+            && rtpDupPerSec_ == dupPerSec && rtpJitterMs_ == jitterMs && framePoolDrops_ == poolDrops) return;
+        rtpNetLostPerSec_ = netLostPerSec;
+        rtpLostPerSec_ = lostPerSec; rtpLatePerSec_ = latePerSec; rtpDupPerSec_ = dupPerSec;
+        rtpJitterMs_ = jitterMs; framePoolDrops_ = poolDrops;
+        emit rtpStatsChanged();
+    }
     void setRecording(bool v)               { if (recording_ == v) return; recording_ = v; emit recordingChanged(); }
     void setRecordFileName(const QString& v){ if (recordFileName_ == v) return; recordFileName_ = v; emit recordFileNameChanged(); }
     void setRecordSegmentIndex(int v)       { if (recordSegmentIndex_ == v) return; recordSegmentIndex_ = v; emit recordSegmentIndexChanged(); }
@@ -137,6 +160,7 @@ signals:
     void deviceOnlineChanged();
     void currentFpsChanged();
     void resolutionChanged();
+    void rtpStatsChanged();
     void recordingChanged();
     void recordFileNameChanged();
     void recordSegmentIndexChanged();
@@ -187,6 +211,12 @@ private:
     bool        deviceOnline_        = false;
     int         currentFps_          = 0;
     QString     resolution_          = "1920x1080";
+    double      rtpNetLostPerSec_    = 0.0;
+    double      rtpLostPerSec_       = 0.0;
+    double      rtpLatePerSec_       = 0.0;
+    double      rtpDupPerSec_        = 0.0;
+    double      rtpJitterMs_         = 0.0;
+    double      framePoolDrops_      = 0.0;
     bool        recording_           = false;
     QString     recordFileName_;
     int         recordSegmentIndex_  = 0;
@@ -1,4 +1,5 @@
 #include "videorecorder.h"
+#include "rtspviewerqt.h"   // wallClockUtcUs：与帧采集墙钟同一时钟
 
 #include <QDate>
 #include <QDateTime>
@@ -6,15 +7,100 @@
 #include <QFileInfo>
 #include <QDebug>
 #include <QMutexLocker>
+#include <QElapsedTimer>
+
+#include <cstring>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <time.h>
+#endif
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 #include <libavutil/avutil.h>
 #include <libavutil/opt.h>
+#include <libavutil/imgutils.h>  // av_image_copy_plane
 #include <libavutil/time.h>     // av_gettime_relative
 #include <libswscale/swscale.h>
 }
+static void ensureFfmpegInit()
+{
+    static bool ffInited = false;
+    if (!ffInited) {
+        av_log_set_level(AV_LOG_ERROR);
+        avformat_network_init();
+        ffInited = true;
+    }
+}
+
+// 当前线程已消耗的 CPU 时间（微秒）。Windows 下按调度时钟片累计（~15.6ms 粒度），
+// 只适合多帧求平均，不适合看单帧
+static qint64 threadCpuUs()
+{
+#ifdef Q_OS_WIN
+    FILETIME c, e, k, u;
+    if (!GetThreadTimes(GetCurrentThread(), &c, &e, &k, &u)) return 0;
+    const quint64 kt = ((quint64)k.dwHighDateTime << 32) | k.dwLowDateTime;
+    const quint64 ut = ((quint64)u.dwHighDateTime << 32) | u.dwLowDateTime;
+    return (qint64)((kt + ut) / 10);   // 100ns -> us
+#else
+    timespec ts;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+    return (qint64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+int VideoRecorder::yuvPixFmt(const YuvFrame& f)
+{
+    return f.format == YuvFrame::NV12 ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+}
+
+// 从 Annex-B AU 中取出参数集作为 MP4 extradata：
+// H264 SPS/PPS（NAL type 7/8），H265 VPS/SPS/PPS（NAL type 32/33/34）
+static QByteArray extractParamSets(const QByteArray& au, VideoCodec codec)
+{
+    QByteArray out;
+    const uchar* p = reinterpret_cast<const uchar*>(au.constData());
+    const int n = au.size();
+
+    auto nextStart = [&](int from, int* scLen) -> int {
+        for (int i = from; i + 3 <= n; ++i) {
+            if (p[i] == 0 && p[i + 1] == 0) {
+                if (p[i + 2] == 1) { *scLen = 3; return i; }
+                if (i + 4 <= n && p[i + 2] == 0 && p[i + 3] == 1) { *scLen = 4; return i; }
+            }
+        }
+        *scLen = 0;
+        return n;
+    };
+
+    int sc = 0;
+    int pos = nextStart(0, &sc);
+    while (pos < n) {
+        const int nalBeg = pos + sc;
+        int sc2 = 0;
+        const int nalEnd = nextStart(nalBeg, &sc2);
+        if (nalBeg < nalEnd) {
+            const bool isParamSet = (codec == VideoCodec::H265)
+                                        ? ((p[nalBeg] >> 1) & 0x3F) >= 32 && ((p[nalBeg] >> 1) & 0x3F) <= 34
+                                        : (p[nalBeg] & 0x1F) == 7 || (p[nalBeg] & 0x1F) == 8;
+            if (isParamSet) {
+                out.append("\x00\x00\x00\x01", 4);
+                out.append(reinterpret_cast<const char*>(p + nalBeg), nalEnd - nalBeg);
+            }
+        }
+        pos = nalEnd;
+        sc = sc2;
+    }
+    return out;
+}
+
 // ========== 构造 / 析构 ==========
 
 VideoRecorder::VideoRecorder(QObject* parent)
@@ -56,7 +142,7 @@ void VideoRecorder::receiveRecordOptions(myRecordOptions myOptions)
 
 // ========== 单帧保存 ==========
 
-void VideoRecorder::receiveFrame2Save(QSharedPointer<QImage> img)
+void VideoRecorder::receiveFrame2Save(QSharedPointer<QImage> img, FrameMeta meta)
 {
     QMutexLocker lk(&mutex_);
     if (img.isNull() || img->isNull()) {
@@ -71,7 +157,7 @@ void VideoRecorder::receiveFrame2Save(QSharedPointer<QImage> img)
     }
 
     ImageFormat fmt = myCaptureType;
-    QString path = makeSnapshotFilePathLocked(fmt);
+    QString path = makeSnapshotFilePathLocked(fmt, meta);
     if (path.isEmpty()) {
         emit sendMSG2ui(QStringLiteral("[VideoRecorder] 单帧保存失败：生成文件路径失败"));
         return;
@@ -89,46 +175,76 @@ void VideoRecorder::receiveFrame2Save(QSharedPointer<QImage> img)
 
 // ========== 录制帧输入 ==========
 
-void VideoRecorder::receiveFrame2Record(QSharedPointer<QImage> img)
+void VideoRecorder::receiveFrame2Record(QSharedPointer<QImage> img, FrameMeta meta)
 {
     QMutexLocker lk(&mutex_);
 
     if (!recording_) return;
+    if (passthroughActive_) return;   // 直通录像只收压缩 AU
+    if (yuvInputActive_) return;      // YUV 输入录像只收平面帧
     if (img.isNull()) return;
 
+    if (!prepareEncoderLocked([&] { return openEncoderLockedForImage(*img); }, false))
+        return;
+
+    if (!encodeImageLocked(*img, meta)) {
+        emit sendMSG2ui(QStringLiteral("[VideoRecorder] 视频编码失败"));
+    }
+}
+
+void VideoRecorder::receiveYuvFrame2Record(QSharedPointer<YuvFrame> frame)
+{
+    QMutexLocker lk(&mutex_);
+
+    if (!recording_ || !yuvInputActive_) return;
+    if (frame.isNull() || frame->width <= 0 || frame->height <= 0) return;
+
+    // 解码链重建后格式/分辨率可能变化（如 d3d11 NV12 -> 软解 I420），按新格式开新段
+    const bool formatChanged = encoderOpened_ &&
+                               (frame->width != encWidth_ || frame->height != encHeight_ ||
+                                yuvPixFmt(*frame) != encPixFmt_);
+
+    if (!prepareEncoderLocked([&] { return openEncoderLockedForYuv(*frame); }, formatChanged))
+        return;
+
+    if (!encodeYuvLocked(*frame)) {
+        emit sendMSG2ui(QStringLiteral("[VideoRecorder] 视频编码失败"));
+    }
+}
+
+void VideoRecorder::setYuvInput(bool on)
+{
+    QMutexLocker lk(&mutex_);
+    yuvInput_ = on;
+}
+
+// 首帧打开编码器；超过 30 分钟（或 rotate=true）时 flush 旧文件并立即开新段
+bool VideoRecorder::prepareEncoderLocked(const std::function<bool()>& open, bool rotate)
+{
     if (!encoderOpened_) {
         frameIndex_ = 0;
         lastPtsMs_ = 0;
         recStartUs_ = 0;
+        srcPtsBaseUs_ = srcPtsLastUs_ = -1;
 
-        if (!openEncoderLockedForImage(*img)) {
+        if (!open()) {
             recording_ = false;
             encoderOpened_ = false;
             const QString r = QStringLiteral("视频录制初始化失败（编码器打开失败，请检查路径/磁盘/H264支持）");
             qWarning() << "[REC-START-FAIL]" << r;
             emit sendMSG2ui(QStringLiteral("[VideoRecorder] ") + r);
             emit recordingFailed(r);   // ← notify MainWindow to reset isRecording_
-            return;
+            return false;
         }
 
         encoderOpened_ = true;
         emit recordingStarted(currentRecordingPath_);
-    } else if (lastPtsMs_ >= kMaxSegmentMs) {
+    } else if (rotate || lastPtsMs_ >= kMaxSegmentMs) {
         // 超过 30 分钟，切换到新文件
         QString finishedPath = currentRecordingPath_;
 
         // flush & 关闭旧文件
-        avcodec_send_frame(codecCtx_, nullptr);
-        while (true) {
-            int r = avcodec_receive_packet(codecCtx_, pkt_);
-            if (r == AVERROR(EAGAIN) || r == AVERROR_EOF) break;
-            if (r < 0) break;
-            pkt_->duration = qMax<int64_t>(1, (int64_t)(1000.0 / encFps_));
-            av_packet_rescale_ts(pkt_, codecCtx_->time_base, videoStream_->time_base);
-            pkt_->stream_index = videoStream_->index;
-            av_interleaved_write_frame(fmtCtx_, pkt_);
-            av_packet_unref(pkt_);
-        }
+        flushEncoderLocked();
         closeEncoderLocked();
         emit recordingStopped(finishedPath);
         emit sendMSG2ui(QStringLiteral("[VideoRecorder] 录像已保存到：%1").arg(finishedPath));
@@ -137,7 +253,79 @@ void VideoRecorder::receiveFrame2Record(QSharedPointer<QImage> img)
         frameIndex_ = 0;
         lastPtsMs_ = 0;
         recStartUs_ = 0;
-        if (!openEncoderLockedForImage(*img)) {
+        srcPtsBaseUs_ = srcPtsLastUs_ = -1;
+        if (!open()) {
+            recording_ = false;
+            encoderOpened_ = false;
+            emit sendMSG2ui(QStringLiteral("[VideoRecorder] 新段录制初始化失败"));
+            return false;
+        }
+        encoderOpened_ = true;
+        emit recordingStarted(currentRecordingPath_);
+    }
+    return true;
+}
+
+// ========== 直通录像：压缩 AU 输入 ==========
+
+void VideoRecorder::setPassthrough(bool on)
+{
+    QMutexLocker lk(&mutex_);
+    passthrough_ = on;
+}
+
+void VideoRecorder::setOverlayMetadata(const QString& text)
+{
+    QMutexLocker lk(&mutex_);
+    overlayMeta_ = text;
+}
+
+void VideoRecorder::setBurnOverlay(bool on)
+{
+    QMutexLocker lk(&mutex_);
+    burnOverlay_ = on;
+}
+
+void VideoRecorder::receiveEncodedPacket(QSharedPointer<EncodedPacket> pkt)
+{
+    QMutexLocker lk(&mutex_);
+
+    if (!recording_ || !passthroughActive_) return;
+    if (pkt.isNull() || pkt->data.isEmpty()) return;
+    // 编码切换后到下一个 IDR 之前的 AU 无法写入任何一个分段
+    if (encoderOpened_ && pkt->codec != muxCodec_ && !pkt->keyframe) return;
+
+    if (!encoderOpened_) {
+        // 文件必须从 IDR 开始，否则开头无法解码
+        if (!pkt->keyframe) return;
+
+        frameIndex_ = 0;
+        lastPtsMs_ = 0;
+        recStartUs_ = 0;
+
+        if (!openMuxerLockedForPacket(*pkt)) {
+            recording_ = false;
+            encoderOpened_ = false;
+            const QString r = QStringLiteral("直通录像初始化失败（封装器打开失败，请检查路径/磁盘）");
+            qWarning() << "[REC-START-FAIL]" << r;
+            emit sendMSG2ui(QStringLiteral("[VideoRecorder] ") + r);
+            emit recordingFailed(r);
+            return;
+        }
+
+        encoderOpened_ = true;
+        emit recordingStarted(currentRecordingPath_);
+    } else if ((lastPtsMs_ >= kMaxSegmentMs || pkt->codec != muxCodec_) && pkt->keyframe) {
+        // 超过 30 分钟（或相机切换了编码），在下一个 IDR 处切换到新文件
+        QString finishedPath = currentRecordingPath_;
+        closeEncoderLocked();
+        emit recordingStopped(finishedPath);
+        emit sendMSG2ui(QStringLiteral("[VideoRecorder] 录像已保存到：%1").arg(finishedPath));
+
+        frameIndex_ = 0;
+        lastPtsMs_ = 0;
+        recStartUs_ = 0;
+        if (!openMuxerLockedForPacket(*pkt)) {
             recording_ = false;
             encoderOpened_ = false;
             emit sendMSG2ui(QStringLiteral("[VideoRecorder] 新段录制初始化失败"));
@@ -147,11 +335,22 @@ void VideoRecorder::receiveFrame2Record(QSharedPointer<QImage> img)
         emit recordingStarted(currentRecordingPath_);
     }
 
-    if (!encodeImageLocked(*img)) {
-        emit sendMSG2ui(QStringLiteral("[VideoRecorder] 视频编码失败"));
+    if (!writePacketLocked(*pkt)) {
+        emit sendMSG2ui(QStringLiteral("[VideoRecorder] 视频写入失败"));
     }
 }
 
+void VideoRecorder::receiveEncodedPreroll(QVector<QSharedPointer<EncodedPacket>> pkts)
+{
+    {
+        QMutexLocker lk(&mutex_);
+        if (!recording_ || !passthroughActive_ || encoderOpened_) return;
+    }
+    qInfo() << "[VideoRecorder] pre-event preroll:" << pkts.size() << "AU";
+    for (const auto& p : pkts)
+        receiveEncodedPacket(p);
+}
+
 // ========== 路径生成 ==========
 
 QString VideoRecorder::makeVideoFilePathLocked(const VideoOptions& opt) const
@@ -185,7 +384,7 @@ QString VideoRecorder::makeVideoFilePathLocked(const VideoOptions& opt) const
     return dateDir.filePath(prefix + "." + ext);
 }
 
-QString VideoRecorder::makeSnapshotFilePathLocked(ImageFormat fmt) const
+QString VideoRecorder::makeSnapshotFilePathLocked(ImageFormat fmt, const FrameMeta& meta) const
 {
     if (snapshotRootDir_.isEmpty())
         return QString();
@@ -209,8 +408,12 @@ QString VideoRecorder::makeSnapshotFilePathLocked(ImageFormat fmt) const
         }
     }
 
-    const QDateTime now = QDateTime::currentDateTime();
-    const QString prefix = now.toString("yyyy-MM-dd_hh-mm-ss_zzz");
+    // 帧本身的时间（采集/到达），请求排队、编码 PNG 的耗时不计入文件名
+    const qint64 utcUs = meta.utcUs();
+    const QDateTime stamp = utcUs > 0 ? QDateTime::fromMSecsSinceEpoch(utcUs / 1000)
+                                      : QDateTime::currentDateTime();
+    QString prefix = stamp.toString("yyyy-MM-dd_hh-mm-ss_zzz");
+    if (!meta.sn.isEmpty()) prefix += "_" + meta.sn;
 
     QString ext = "png";
     if (fmt == ImageFormat::JPG) ext = "jpg";
@@ -270,36 +473,33 @@ void VideoRecorder::startRecording()
 
     recording_ = true;
     encoderOpened_ = false;
+    passthroughActive_ = passthrough_;
+    yuvInputActive_ = !passthrough_ && yuvInput_;
+    burnOverlayActive_ = !passthrough_ && burnOverlay_;
     currentRecordingPath_.clear();
 
-    qInfo() << "[REC-STATE] startRecording done: recording_=true, waiting first frame to open encoder";
-    emit sendMSG2ui(QStringLiteral("[VideoRecorder] startRecording"));
+    qInfo() << "[REC-STATE] startRecording done: recording_=true, passthrough=" << passthroughActive_
+            << ", input=" << (yuvInputActive_ ? "yuv" : "bgra")
+            << ", overlay=" << burnOverlayActive_
+            << ", waiting first frame to open" << (passthroughActive_ ? "muxer (IDR)" : "encoder");
+    emit sendMSG2ui(passthroughActive_
+                        ? QStringLiteral("[VideoRecorder] startRecording (passthrough)")
+                        : QStringLiteral("[VideoRecorder] startRecording"));
 }
 
 void VideoRecorder::stopRecording()
 {
     QMutexLocker lk(&mutex_);
 
-    if (!recording_) return;
+    // 无论是否真的写过文件都发 recordingStopped（路径可能为空：直通还在等首个 IDR、
+    // 封装器/编码器打开失败），界面上的"正在保存"对话框靠它关闭
+    if (!recording_) {
+        emit recordingStopped(QString());
+        return;
+    }
 
     // flush
-    if (encoderOpened_ && codecCtx_) {
-        avcodec_send_frame(codecCtx_, nullptr);
-
-        while (true) {
-            int ret = avcodec_receive_packet(codecCtx_, pkt_);
-            if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
-            if (ret < 0) break;
-
-            // packet duration（毫秒 time_base）
-            pkt_->duration = qMax<int64_t>(1, (int64_t)(1000.0 / encFps_));
-
-            av_packet_rescale_ts(pkt_, codecCtx_->time_base, videoStream_->time_base);
-            pkt_->stream_index = videoStream_->index;
-            av_interleaved_write_frame(fmtCtx_, pkt_);
-            av_packet_unref(pkt_);
-        }
-    }
+    if (encoderOpened_ && codecCtx_) flushEncoderLocked();
 
     QString finishedPath = currentRecordingPath_;
     closeEncoderLocked();
@@ -308,25 +508,32 @@ void VideoRecorder::stopRecording()
     encoderOpened_ = false;
     currentRecordingPath_.clear();
 
-    if (!finishedPath.isEmpty()) {
-        emit recordingStopped(finishedPath);
+    emit recordingStopped(finishedPath);
+    if (!finishedPath.isEmpty())
         emit sendMSG2ui(QStringLiteral("[VideoRecorder] 录像已保存到：%1").arg(finishedPath));
-    }
+    else
+        emit sendMSG2ui(QStringLiteral("[VideoRecorder] 录像已停止（尚未写入任何帧，未生成文件）"));
 }
 
 // ========== 核心：打开编码器 ==========
 
 bool VideoRecorder::openEncoderLockedForImage(const QImage &img)
 {
-    static bool ffInited = false;
-    if (!ffInited) {
-        av_log_set_level(AV_LOG_ERROR);
-        avformat_network_init();
-        ffInited = true;
-    }
+    return openEncoderLocked(img.width(), img.height(), AV_PIX_FMT_BGRA);
+}
+
+bool VideoRecorder::openEncoderLockedForYuv(const YuvFrame &frame)
+{
+    return openEncoderLocked(frame.width, frame.height, yuvPixFmt(frame));
+}
+
+// srcPixFmt: BGRA 时经 sws 转 YUV420P；I420/NV12 时编码器直接以该格式打开，不做色彩转换
+bool VideoRecorder::openEncoderLocked(int width, int height, int srcPixFmt)
+{
+    ensureFfmpegInit();
 
-    encWidth_  = img.width();
-    encHeight_ = img.height();
+    encWidth_  = width;
+    encHeight_ = height;
     if (encWidth_ <= 0 || encHeight_ <= 0) {
         qWarning() << "[VideoRecorder] invalid frame size" << encWidth_ << "x" << encHeight_;
         return false;
@@ -379,7 +586,9 @@ bool VideoRecorder::openEncoderLockedForImage(const QImage &img)
     codecCtx_->codec_id = codecId;
     codecCtx_->width    = encWidth_;
     codecCtx_->height   = encHeight_;
-    codecCtx_->pix_fmt  = AV_PIX_FMT_YUV420P;
+    // libx264 原生接受 yuv420p / nv12
+    codecCtx_->pix_fmt  = (srcPixFmt == AV_PIX_FMT_NV12) ? AV_PIX_FMT_NV12 : AV_PIX_FMT_YUV420P;
+    encPixFmt_ = srcPixFmt;
     codecCtx_->bit_rate = (int64_t)currentOptions_.bitrateKbps * 1000LL;
 
     // 关键修复：用毫秒 time_base，后续 pts 用真实时间（避免时长漂）
@@ -432,13 +641,15 @@ bool VideoRecorder::openEncoderLockedForImage(const QImage &img)
         return false;
     }
 
-    // BGRA 直接送 sws，省掉每帧 convertToFormat(RGB888)
-    swsCtx_ = sws_getContext(encWidth_, encHeight_, AV_PIX_FMT_BGRA,
-                             encWidth_, encHeight_, AV_PIX_FMT_YUV420P,
-                             SWS_BILINEAR, nullptr, nullptr, nullptr);
-    if (!swsCtx_) {
-        qWarning() << "[VideoRecorder] sws_getContext failed.";
-        return false;
+    // BGRA 直接送 sws，省掉每帧 convertToFormat(RGB888)；平面 YUV 输入不需要 sws
+    if (srcPixFmt == AV_PIX_FMT_BGRA) {
+        swsCtx_ = sws_getContext(encWidth_, encHeight_, AV_PIX_FMT_BGRA,
+                                 encWidth_, encHeight_, AV_PIX_FMT_YUV420P,
+                                 SWS_BILINEAR, nullptr, nullptr, nullptr);
+        if (!swsCtx_) {
+            qWarning() << "[VideoRecorder] sws_getContext failed.";
+            return false;
+        }
     }
 
     if (!(fmtCtx_->oformat->flags & AVFMT_NOFILE)) {
@@ -469,13 +680,14 @@ bool VideoRecorder::openEncoderLockedForImage(const QImage &img)
 
     qDebug().noquote() << "[VideoRecorder] start writing to " << currentRecordingPath_
                        << "enc=" << encWidth_ << "x" << encHeight_
-                       << "fps(meta)=" << encFps_;
+                       << "fps(meta)=" << encFps_
+                       << "input=" << (swsCtx_ ? "bgra" : "yuv");
     return true;
 }
 
 // ========== 核心：编码一帧 ==========
 
-bool VideoRecorder::encodeImageLocked(const QImage &img)
+bool VideoRecorder::encodeImageLocked(const QImage &img, const FrameMeta &meta)
 {
     if (!fmtCtx_ || !codecCtx_ || !frame_ || !swsCtx_ || !videoStream_)
         return false;
@@ -492,6 +704,9 @@ bool VideoRecorder::encodeImageLocked(const QImage &img)
         return false;
     }
 
+    const qint64 cpu0 = threadCpuUs();
+    QElapsedTimer tConv; tConv.start();
+
     // 关键修复2：复用 AVFrame 前必须可写（避免偶发黑帧）
     int ret = av_frame_make_writable(frame_);
     if (ret < 0) {
@@ -499,7 +714,8 @@ bool VideoRecorder::encodeImageLocked(const QImage &img)
         return false;
     }
 
-    const uint8_t *srcData[1] = { src.bits() };
+    // constBits：零拷贝帧是只读包装，bits() 会触发整帧 detach 拷贝
+    const uint8_t *srcData[1] = { src.constBits() };
     int srcStride[1]          = { src.bytesPerLine() };
 
     // BGRA -> YUV420P
@@ -511,17 +727,87 @@ bool VideoRecorder::encodeImageLocked(const QImage &img)
         qWarning() << "[VideoRecorder] sws_scale failed, ret =" << ret;
         return false;
     }
+    blendOverlayLocked(meta);
+    convertHist_.record(tConv.nsecsElapsed() / 1000);
+
+    const bool ok = encodeFrameLocked(meta);
+    encCpuUs_ += threadCpuUs() - cpu0;
+    return ok;
+}
+
+// ========== 核心：编码一帧平面 YUV（只做平面拷贝，无色彩转换） ==========
+
+bool VideoRecorder::encodeYuvLocked(const YuvFrame &f)
+{
+    if (!fmtCtx_ || !codecCtx_ || !frame_ || !videoStream_ || swsCtx_)
+        return false;
+
+    const qint64 cpu0 = threadCpuUs();
+    QElapsedTimer tConv; tConv.start();
+
+    int ret = av_frame_make_writable(frame_);
+    if (ret < 0) {
+        qWarning() << "[VideoRecorder] av_frame_make_writable failed, ret =" << ret;
+        return false;
+    }
+
+    // 解码缓冲随 YuvFrame 释放归还，编码器可能延迟引用输入帧，所以拷进自己的 AVFrame
+    const int chromaH = (encHeight_ + 1) / 2;
+    if (f.format == YuvFrame::NV12) {
+        av_image_copy_plane(frame_->data[0], frame_->linesize[0], f.data[0], f.stride[0], encWidth_, encHeight_);
+        av_image_copy_plane(frame_->data[1], frame_->linesize[1], f.data[1], f.stride[1],
+                            ((encWidth_ + 1) / 2) * 2, chromaH);
+    } else {
+        av_image_copy_plane(frame_->data[0], frame_->linesize[0], f.data[0], f.stride[0], encWidth_, encHeight_);
+        av_image_copy_plane(frame_->data[1], frame_->linesize[1], f.data[1], f.stride[1], (encWidth_ + 1) / 2, chromaH);
+        av_image_copy_plane(frame_->data[2], frame_->linesize[2], f.data[2], f.stride[2], (encWidth_ + 1) / 2, chromaH);
+    }
+    blendOverlayLocked(f.meta);
+    convertHist_.record(tConv.nsecsElapsed() / 1000);
+
+    const bool ok = encodeFrameLocked(f.meta);
+    encCpuUs_ += threadCpuUs() - cpu0;
+    return ok;
+}
+
+// frame_ 已填好（编码器自己的缓冲）：原位写叠加横幅，源帧（可能是解码器缓冲）保持只读
+void VideoRecorder::blendOverlayLocked(const FrameMeta &meta)
+{
+    if (!burnOverlayActive_) return;
+    uchar* planes[3] = { frame_->data[0], frame_->data[1], frame_->data[2] };
+    overlay_.blendIntoYuv420(planes, frame_->linesize, encWidth_, encHeight_,
+                             frame_->format == AV_PIX_FMT_NV12, meta.utcUs(), overlayMeta_);
+}
 
-    // 关键修复3：真实时间 PTS（毫秒），解决“10秒显示1分钟”
-    if (recStartUs_ <= 0) recStartUs_ = (qint64)av_gettime_relative();
-    qint64 nowUs = (qint64)av_gettime_relative();
-    qint64 ms = (nowUs - recStartUs_) / 1000;   // 毫秒
+// frame_ 已填好：按帧 PTS 打时间戳，送编码器并写出所有可取的包
+bool VideoRecorder::encodeFrameLocked(const FrameMeta &meta)
+{
+    int ret = 0;
+    const qint64 frameMs = qMax<qint64>(1, (qint64)(1000.0 / encFps_));
+
+    qint64 ms = 0;
+    if (meta.ptsNs >= 0) {
+        // 帧 PTS 来自 RTP 时间戳，反映采集节奏；排队/编码耗时不影响时间轴。
+        // 重连后新会话 PTS 不连续（倒退或跳变超过 2 s）：接在上一帧之后重新对齐
+        const qint64 ptsUs = meta.ptsNs / 1000;
+        if (srcPtsBaseUs_ < 0)
+            srcPtsBaseUs_ = ptsUs - (frameIndex_ > 0 ? (lastPtsMs_ + frameMs) * 1000 : 0);
+        else if (ptsUs < srcPtsLastUs_ || ptsUs - srcPtsLastUs_ > 2 * 1000 * 1000)
+            srcPtsBaseUs_ = ptsUs - (lastPtsMs_ + frameMs) * 1000;
+        srcPtsLastUs_ = ptsUs;
+        ms = (ptsUs - srcPtsBaseUs_) / 1000;
+    } else {
+        // 无 PTS（不应出现）：退回真实时间 PTS（毫秒）
+        if (recStartUs_ <= 0) recStartUs_ = (qint64)av_gettime_relative();
+        ms = ((qint64)av_gettime_relative() - recStartUs_) / 1000;
+    }
 
     // 单调递增（避免相等/倒退导致播放器时长计算异常）
     if (ms <= lastPtsMs_) ms = lastPtsMs_ + 1;
     lastPtsMs_ = ms;
 
     frame_->pts = (int64_t)ms;
+    if (meta.captureUtcUs > 0) pendingCaptureUs_.insert(ms, meta.captureUtcUs);
 
     // 4) 编码
     ret = avcodec_send_frame(codecCtx_, frame_);
@@ -540,7 +826,8 @@ bool VideoRecorder::encodeImageLocked(const QImage &img)
         }
 
         // 给 packet 补 duration（毫秒 time_base）
-        pkt_->duration = qMax<int64_t>(1, (int64_t)(1000.0 / encFps_));
+        pkt_->duration = frameMs;
+        const qint64 capUs = pendingCaptureUs_.take((qint64)pkt_->pts);
 
         av_packet_rescale_ts(pkt_, codecCtx_->time_base, videoStream_->time_base);
         pkt_->stream_index = videoStream_->index;
@@ -551,12 +838,195 @@ bool VideoRecorder::encodeImageLocked(const QImage &img)
             qWarning() << "[VideoRecorder] av_interleaved_write_frame failed, ret =" << ret;
             return false;
         }
+        if (capUs > 0) muxLatHist_.record(RtspViewerQt::wallClockUtcUs() - capUs);
     }
 
     frameIndex_++;
     return true;
 }
 
+void VideoRecorder::flushEncoderLocked()
+{
+    avcodec_send_frame(codecCtx_, nullptr);
+
+    while (true) {
+        int ret = avcodec_receive_packet(codecCtx_, pkt_);
+        if (ret == AVERROR(EAGAIN) || ret == AVERROR_EOF) break;
+        if (ret < 0) break;
+
+        // packet duration（毫秒 time_base）
+        pkt_->duration = qMax<int64_t>(1, (int64_t)(1000.0 / encFps_));
+
+        av_packet_rescale_ts(pkt_, codecCtx_->time_base, videoStream_->time_base);
+        pkt_->stream_index = videoStream_->index;
+        av_interleaved_write_frame(fmtCtx_, pkt_);
+        av_packet_unref(pkt_);
+    }
+}
+
+// ========== 直通：打开封装器（无编码器） ==========
+
+bool VideoRecorder::openMuxerLockedForPacket(const EncodedPacket &pkt)
+{
+    ensureFfmpegInit();
+
+    encWidth_  = pkt.width;
+    encHeight_ = pkt.height;
+    if (encWidth_ <= 0 || encHeight_ <= 0) {
+        qWarning() << "[VideoRecorder] passthrough: caps without size, assume 1920x1080";
+        encWidth_  = 1920;
+        encHeight_ = 1080;
+    }
+    encFps_ = (currentOptions_.fps > 0) ? currentOptions_.fps : 25.0;
+
+    const bool hevc = (pkt.codec == VideoCodec::H265);
+    const QByteArray paramSets = extractParamSets(pkt.data, pkt.codec);
+    if (paramSets.isEmpty()) {
+        qWarning() << "[VideoRecorder] passthrough: no parameter sets in first IDR, hevc=" << hevc;
+        return false;
+    }
+
+    currentRecordingPath_ = makeVideoFilePathLocked(currentOptions_);
+    if (currentRecordingPath_.isEmpty()) {
+        qWarning() << "[VideoRecorder] makeVideoFilePathLocked failed.";
+        return false;
+    }
+
+    // 头写入前失败：不能走 closeEncoderLocked（av_write_trailer 需要已写头）
+    auto fail = [this](const char* what, int ret) {
+        qWarning() << "[VideoRecorder] passthrough:" << what << "failed, ret =" << ret;
+        if (fmtCtx_) {
+            if (!(fmtCtx_->oformat->flags & AVFMT_NOFILE) && fmtCtx_->pb)
+                avio_closep(&fmtCtx_->pb);
+            avformat_free_context(fmtCtx_);
+            fmtCtx_ = nullptr;
+        }
+        videoStream_ = nullptr;
+        return false;
+    };
+
+    int ret = avformat_alloc_output_context2(
+        &fmtCtx_, nullptr, nullptr,
+        currentRecordingPath_.toUtf8().constData()
+        );
+    if (!fmtCtx_) return fail("avformat_alloc_output_context2", ret);
+
+    videoStream_ = avformat_new_stream(fmtCtx_, nullptr);
+    if (!videoStream_) return fail("avformat_new_stream", 0);
+    videoStream_->id = fmtCtx_->nb_streams - 1;
+
+    AVCodecParameters* par = videoStream_->codecpar;
+    par->codec_type = AVMEDIA_TYPE_VIDEO;
+    par->codec_id   = hevc ? AV_CODEC_ID_HEVC : AV_CODEC_ID_H264;
+    // hvc1：参数集放在 hvcC 里，QuickTime/浏览器可直接播放
+    if (hevc) par->codec_tag = MKTAG('h', 'v', 'c', '1');
+    par->width      = encWidth_;
+    par->height     = encHeight_;
+    par->format     = AV_PIX_FMT_YUV420P;
+
+    // Annex-B 参数集：mov 封装器写头时转换为 avcC / hvcC
+    par->extradata = static_cast<uint8_t*>(av_mallocz(paramSets.size() + AV_INPUT_BUFFER_PADDING_SIZE));
+    if (!par->extradata) return fail("av_mallocz(extradata)", 0);
+    memcpy(par->extradata, paramSets.constData(), paramSets.size());
+    par->extradata_size = paramSets.size();
+
+    videoStream_->time_base      = AVRational{1, 1000};
+    videoStream_->avg_frame_rate = AVRational{(int)encFps_, 1};
+    videoStream_->r_frame_rate   = AVRational{(int)encFps_, 1};
+
+    // 叠加信息不烧录进画面，写入容器元数据
+    if (!overlayMeta_.isEmpty())
+        av_dict_set(&fmtCtx_->metadata, "comment", overlayMeta_.toUtf8().constData(), 0);
+    av_dict_set(&fmtCtx_->metadata, "creation_time",
+                QDateTime::currentDateTimeUtc().toString(Qt::ISODateWithMs).toUtf8().constData(), 0);
+
+    if (!(fmtCtx_->oformat->flags & AVFMT_NOFILE)) {
+        ret = avio_open(&fmtCtx_->pb, currentRecordingPath_.toUtf8().constData(), AVIO_FLAG_WRITE);
+        if (ret < 0) return fail("avio_open", ret);
+    }
+
+    AVDictionary* muxOpts = nullptr;
+    if (currentOptions_.container == VideoContainer::MP4) {
+        av_dict_set(&muxOpts, "movflags", "+faststart", 0);
+    }
+    ret = avformat_write_header(fmtCtx_, &muxOpts);
+    av_dict_free(&muxOpts);
+    if (ret < 0) return fail("avformat_write_header", ret);
+
+    pkt_ = av_packet_alloc();
+    if (!pkt_) {
+        qWarning() << "[VideoRecorder] alloc packet failed.";
+        return false;
+    }
+
+    ptStartUs_  = pkt.ptsUs;
+    ptLastUs_   = -1;
+    muxCodec_   = pkt.codec;
+    recStartUs_ = (qint64)av_gettime_relative();
+    lastPtsMs_  = 0;
+
+    qDebug().noquote() << "[VideoRecorder] start passthrough writing to " << currentRecordingPath_
+                       << "size=" << encWidth_ << "x" << encHeight_
+                       << "codec=" << (hevc ? "H265" : "H264");
+    return true;
+}
+
+// ========== 直通：写一个 AU ==========
+
+bool VideoRecorder::writePacketLocked(const EncodedPacket &pkt)
+{
+    if (!fmtCtx_ || !videoStream_ || !pkt_)
+        return false;
+
+    const qint64 frameMs = (pkt.durationUs > 0) ? qMax<qint64>(1, pkt.durationUs / 1000)
+                                                : qMax<qint64>(1, (qint64)(1000.0 / encFps_));
+
+    // 相机流 PTS（捕获节拍），无 PTS 时退回到达时间。
+    // 重连（热重启/整管重建）后新会话 PTS 不连续（倒退或跳变超过 2 s）：与重编码路径一样，
+    // 接在上一 AU 之后重新对齐，否则之后的 AU 全被钳到 lastPtsMs_ + 1，分段切换也随之推迟
+    qint64 ms = 0;
+    if (pkt.ptsUs >= 0 && ptStartUs_ >= 0) {
+        if (ptLastUs_ >= 0 && (pkt.ptsUs < ptLastUs_ || pkt.ptsUs - ptLastUs_ > 2 * 1000 * 1000)) {
+            qInfo() << "[VideoRecorder] passthrough: PTS discontinuity" << (pkt.ptsUs - ptLastUs_) / 1000
+                    << "ms, rebase at" << lastPtsMs_ + frameMs << "ms";
+            ptStartUs_ = pkt.ptsUs - (lastPtsMs_ + frameMs) * 1000;
+        }
+        ptLastUs_ = pkt.ptsUs;
+        ms = (pkt.ptsUs - ptStartUs_) / 1000;
+    } else {
+        if (recStartUs_ <= 0) recStartUs_ = (qint64)av_gettime_relative();
+        ms = ((qint64)av_gettime_relative() - recStartUs_) / 1000;
+    }
+    // 单调递增（相机为低延迟配置，无 B 帧，pts == dts）
+    if (ms <= lastPtsMs_) ms = lastPtsMs_ + 1;
+    lastPtsMs_ = ms;
+
+    int ret = av_new_packet(pkt_, pkt.data.size());
+    if (ret < 0) {
+        qWarning() << "[VideoRecorder] av_new_packet failed, ret =" << ret;
+        return false;
+    }
+    memcpy(pkt_->data, pkt.data.constData(), pkt.data.size());
+
+    pkt_->pts = pkt_->dts = (int64_t)ms;
+    pkt_->duration = frameMs;
+    if (pkt.keyframe) pkt_->flags |= AV_PKT_FLAG_KEY;
+
+    av_packet_rescale_ts(pkt_, AVRational{1, 1000}, videoStream_->time_base);
+    pkt_->stream_index = videoStream_->index;
+
+    ret = av_interleaved_write_frame(fmtCtx_, pkt_);
+    av_packet_unref(pkt_);
+    if (ret < 0) {
+        qWarning() << "[VideoRecorder] av_interleaved_write_frame failed, ret =" << ret;
+        return false;
+    }
+    if (pkt.captureUtcUs > 0) muxLatHist_.record(RtspViewerQt::wallClockUtcUs() - pkt.captureUtcUs);
+
+    frameIndex_++;
+    return true;
+}
+
 // ========== 关闭编码器 ==========
 
 void VideoRecorder::closeEncoderLocked()
@@ -597,6 +1067,36 @@ void VideoRecorder::closeEncoderLocked()
 
     recStartUs_ = 0;
     lastPtsMs_ = 0;
+    ptStartUs_ = -1;
+    ptLastUs_  = -1;
+
+    if (muxLatHist_.count() > 0) {
+        const LatencySummary s = muxLatHist_.summary();
+        qInfo().noquote() << QString("[VideoRecorder] capture->mux p50=%1ms p90=%2ms p99=%3ms max=%4ms n=%5")
+                                 .arg(s.p50Ms, 0, 'f', 1)
+                                 .arg(s.p90Ms, 0, 'f', 1)
+                                 .arg(s.p99Ms, 0, 'f', 1)
+                                 .arg(s.maxMs, 0, 'f', 1)
+                                 .arg(s.count);
+    }
+    muxLatHist_.reset();
+    pendingCaptureUs_.clear();
+
+    // 录像线程每帧 CPU（色彩转换/平面拷贝 + 叠加横幅 + 送编码器；x264 自身工作线程不计入）
+    if (convertHist_.count() > 0) {
+        const LatencySummary c = convertHist_.summary();
+        qInfo().noquote() << QString("[VideoRecorder] input=%1%6 frames=%2 cpu/frame=%3ms convert p50=%4ms p99=%5ms")
+                                 .arg(encPixFmt_ == AV_PIX_FMT_BGRA ? "bgra" : "yuv")
+                                 .arg(c.count)
+                                 .arg(encCpuUs_ / 1000.0 / c.count, 0, 'f', 2)
+                                 .arg(c.p50Ms, 0, 'f', 2)
+                                 .arg(c.p99Ms, 0, 'f', 2)
+                                 .arg(burnOverlayActive_ ? QString("+overlay(renders=%1)").arg(overlay_.renderCount())
+                                                         : QString());
+    }
+    convertHist_.reset();
+    encCpuUs_ = 0;
+    encPixFmt_ = -1;
 
     qDebug() << "[VideoRecorder] encoder closed.";
 }
@@ -5,7 +5,11 @@
 #include <QMutex>
 #include <QString>
 #include <QDateTime>
+#include <QHash>
+#include <functional>
 #include <myStruct.h>   // 里面定义了 myRecordOptions / ImageFormat / VideoContainer
+#include "latencyhistogram.h"
+#include "overlaystripcache.h"
 
 // FFmpeg 前向声明，避免在头文件里包含一堆 C 头
 struct AVFormatContext;
@@ -38,22 +42,39 @@ public:
 
 public slots:
     void receiveRecordOptions(myRecordOptions myOptions);
-    void receiveFrame2Save(QSharedPointer<QImage> img);
-    void receiveFrame2Record(QSharedPointer<QImage> img);
+    // meta: 帧元数据；文件名用帧时间（FrameMeta::utcUs()）与 SN，而不是写文件的时刻
+    void receiveFrame2Save(QSharedPointer<QImage> img, FrameMeta meta = FrameMeta());
+    // meta: 帧元数据；PTS 取自帧 PTS（采集节奏），captureUtcUs 用于统计采集→封装延迟
+    void receiveFrame2Record(QSharedPointer<QImage> img, FrameMeta meta = FrameMeta());
+    // 平面 YUV 录像输入（I420/NV12 直接送编码器，不经 sws）；仅 setYuvInput(true) 的录制接收
+    void receiveYuvFrame2Record(QSharedPointer<YuvFrame> frame);
+    void receiveEncodedPacket(QSharedPointer<EncodedPacket> pkt);
+    // 预录缓冲（IDR 起始），在 startRecording 之后、实时 AU 之前到达
+    void receiveEncodedPreroll(QVector<QSharedPointer<EncodedPacket>> pkts);
+
+    // 直通录像：下一次 startRecording 起生效（录制中切换不影响当前文件）
+    void setPassthrough(bool on);
+    // 录像输入选平面 YUV（true）还是 BGRA（false）：下一次 startRecording 起生效，直通录像时忽略
+    void setYuvInput(bool on);
+    // 叠加文字：重编码录像烧录进横幅；直通录像无法烧录，改写入 MP4 元数据（comment）
+    void setOverlayMetadata(const QString& text);
+    // 重编码录像是否烧录叠加横幅（时间戳 + 叠加文字）：下一次 startRecording 起生效。
+    // 横幅在编码器输入（sws 输出 / 平面 YUV 拷贝）上原位写入，每帧代价只与横幅大小有关
+    void setBurnOverlay(bool on);
 
     void startRecording();   // ✅ 无参数
     void stopRecording();    // ✅ 无参数
 
 signals:
     void recordingStarted(const QString& filePath);
-    void recordingStopped(const QString& filePath);
+    void recordingStopped(const QString& filePath);   // stopRecording 总会发出；未生成文件时 filePath 为空
     void recordingFailed(const QString& reason);   // encoder init failed → MainWindow resets isRecording_
     void snapshotSaved(const QString& filePath);
     void sendMSG2ui(const QString&);
 
 private:
     QString makeVideoFilePathLocked(const VideoOptions& opt) const;
-    QString makeSnapshotFilePathLocked(ImageFormat fmt) const;
+    QString makeSnapshotFilePathLocked(ImageFormat fmt, const FrameMeta& meta) const;
 
     static const char* imageFormatToQtString(ImageFormat fmt);
     static QString containerToExtension(VideoContainer c);
@@ -77,8 +98,10 @@ private:
     QImage lastFrame_;
 
     // 用于“真实时间PTS”的基准与单调控制（解决时长漂移）
-    qint64 recStartUs_ = 0;     // 录制开始的时间（微秒）
+    qint64 recStartUs_ = 0;     // 录制开始的时间（微秒），帧无 PTS 时的兜底
     qint64 lastPtsMs_  = 0;     // 上一次写入的 pts（毫秒），保证单调递增
+    qint64 srcPtsBaseUs_ = -1;  // 重编码：本段 pts 0 对应的帧 PTS（微秒），-1 = 未对齐
+    qint64 srcPtsLastUs_ = -1;  // 上一帧的帧 PTS（检测重连造成的不连续）
 
     // 挂起的截图请求
     bool pendingSnapshot_ = false;
@@ -101,7 +124,44 @@ private:
 
     static constexpr qint64 kMaxSegmentMs = 30LL * 60 * 1000; // 30 分钟
 
+    // 直通录像状态
+    bool    passthrough_       = false;   // 配置
+    bool    passthroughActive_ = false;   // 当前录制实际模式（startRecording 时锁定）
+    qint64  ptStartUs_         = -1;      // 当前分段 pts 0 对应的 AU PTS（微秒；重连不连续时重新对齐）
+    qint64  ptLastUs_          = -1;      // 上一 AU 的 PTS（检测重连造成的不连续）
+    VideoCodec muxCodec_       = VideoCodec::H264;   // 当前分段的编码
+    QString overlayMeta_;
+
+    // 叠加横幅（录像线程独占）
+    bool    burnOverlay_       = false;   // 配置
+    bool    burnOverlayActive_ = false;   // 当前录制（startRecording 时锁定；直通录像恒为 false）
+    OverlayStripCache overlay_;
+
+    // 平面 YUV 输入
+    bool    yuvInput_          = false;   // 配置
+    bool    yuvInputActive_    = false;   // 当前录制实际输入（startRecording 时锁定）
+    int     encPixFmt_         = -1;      // 当前分段的输入像素格式（AVPixelFormat）
+
+    // 每段统计：色彩转换/平面拷贝耗时 + 录像线程每帧 CPU
+    LatencyHistogram convertHist_;
+    qint64  encCpuUs_          = 0;
+
+    // 端到端延迟：采集墙钟 → av_interleaved_write_frame 返回，每段关闭时输出
+    LatencyHistogram muxLatHist_;
+    QHash<qint64, qint64> pendingCaptureUs_;   // 编码器 pts(ms) → 采集墙钟（编码器有帧延迟）
+
+    static int yuvPixFmt(const YuvFrame &f);
+
+    bool prepareEncoderLocked(const std::function<bool()> &open, bool rotate);
+    bool openEncoderLocked(int width, int height, int srcPixFmt);
     bool openEncoderLockedForImage(const QImage &img);
-    bool encodeImageLocked(const QImage &img);
+    bool openEncoderLockedForYuv(const YuvFrame &frame);
+    bool encodeImageLocked(const QImage &img, const FrameMeta &meta);
+    bool encodeYuvLocked(const YuvFrame &frame);
+    bool encodeFrameLocked(const FrameMeta &meta);
+    void blendOverlayLocked(const FrameMeta &meta);
+    void flushEncoderLocked();
+    bool openMuxerLockedForPacket(const EncodedPacket &pkt);
+    bool writePacketLocked(const EncodedPacket &pkt);
     void closeEncoderLocked();
 };
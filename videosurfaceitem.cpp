@@ -0,0 +1,473 @@
+#include "videosurfaceitem.h"
+#include "framescaler.h"
+
+#include <QCursor>
+#include <QMatrix4x4>
+#include <QMouseEvent>
+#include <QQuickWindow>
+#include <QSGImageNode>
+#include <QSGRectangleNode>
+#include <QSGTexture>
+#include <QSGTransformNode>
+#include <QThread>
+#include <QWheelEvent>
+#include <QtMath>
+#include <cmath>
+
+namespace {
+
+// 根节点：[变换节点 → 图像节点、叠加横幅] + [十字准线（不随缩放变换）]
+class VideoSurfaceNode : public QSGNode
+{
+public:
+    VideoSurfaceNode()
+    {
+        appendChildNode(xform);
+        appendChildNode(cross);
+    }
+    ~VideoSurfaceNode() override { delete texture; delete overlayTexture; }   // 子节点由 QSGNode 析构
+
+    QSGTransformNode* xform   = new QSGTransformNode;
+    QSGImageNode*     image   = nullptr;
+    QSGTexture*       texture = nullptr;               // 图像节点不持有，替换时自己释放
+    QSGImageNode*     overlay = nullptr;
+    QSGTexture*       overlayTexture = nullptr;
+    QSGNode*          cross   = new QSGNode;
+    QSGRectangleNode* arms[3] = {};                    // 横、竖、中心点
+};
+
+} // namespace
+
+VideoSurfaceItem::VideoSurfaceItem(QQuickItem* parent)
+    : QQuickItem(parent)
+{
+    setFlag(ItemHasContents, true);
+    setClip(true);                                     // 放大后超出视频区的部分裁掉
+    setAcceptedMouseButtons(Qt::LeftButton);
+}
+
+VideoSurfaceItem::~VideoSurfaceItem()
+{
+    setPrescaleEnabled(false);
+}
+
+void VideoSurfaceItem::setPrescaleEnabled(bool on)
+{
+    if (on == (prescaler_ != nullptr)) return;
+    if (on) {
+        prescaleThread_ = new QThread(this);
+        prescaler_ = new FrameScaler;
+        prescaler_->moveToThread(prescaleThread_);
+        connect(prescaleThread_, &QThread::finished, prescaler_, &QObject::deleteLater);
+        connect(prescaler_, &FrameScaler::scaled, this, &VideoSurfaceItem::onScaled);
+        prescaleThread_->start();
+    } else {
+        prescaleThread_->quit();
+        prescaleThread_->wait();
+        delete prescaleThread_;
+        prescaleThread_ = nullptr;
+        prescaler_ = nullptr;
+        scaled_ = QImage();
+        ++prescaleGen_;
+    }
+    update();
+}
+
+void VideoSurfaceItem::setZoomRange(double minZ, double maxZ)
+{
+    minZoom_ = minZ;
+    maxZoom_ = maxZ;
+    clampZoom();
+    update();
+}
+
+void VideoSurfaceItem::setDisplayCrop(int left, int right)
+{
+    cropLeft_ = left;
+    cropRight_ = right;
+    clampPan();
+    update();
+}
+
+void VideoSurfaceItem::setCrosshairEnabled(bool en)
+{
+    if (crosshairEnabled_ == en) return;
+    crosshairEnabled_ = en;
+    emit crosshairEnabledChanged();
+    update();
+}
+
+void VideoSurfaceItem::setImage(const QImage& img, const QSize& logicalSize)
+{
+    if (img.isNull()) return;
+    pending_ = img;
+    imageDirty_ = true;
+    imgSize_ = img.size();
+
+    const QSize logical = logicalSize.isValid() ? logicalSize : img.size();
+    if (logical != lastImgSize_) {
+        lastImgSize_ = logical;
+        resetView();
+    }
+
+    if (prescaler_) {
+        const PrescaleTarget& t = currentPrescaleTarget();
+        if (!t.dst.isEmpty()) {
+            prescaler_->submit(img, t.src, t.dst, prescaleGen_);
+            if (!scaled_.isNull()) return;   // 继续显示上一帧的缩放结果，新结果到达时再刷新
+        }
+    }
+    update();
+}
+
+// 可见区域在场景坐标下对齐到设备像素，缩放结果按 1:1 落在屏幕像素上
+VideoSurfaceItem::PrescaleTarget VideoSurfaceItem::computePrescaleTarget() const
+{
+    PrescaleTarget t;
+    if (!hasImage() || imgSize_.isEmpty() || !window()) return t;
+    const QSizeF iw = croppedSize();
+    const double s = fitScale() * zoom_;
+    if (s <= 0.0) return t;
+
+    const QPointF tl = drawTopLeft(s);
+    const QPointF origin = mapToScene(QPointF(0, 0));
+    const double dpr = window()->effectiveDevicePixelRatio();
+    const QRectF vis = QRectF(tl, iw * s).intersected(QRectF(0, 0, width(), height())).translated(origin);
+    const long l = std::lround(vis.left() * dpr),  r = std::lround(vis.right() * dpr);
+    const long u = std::lround(vis.top() * dpr),   d = std::lround(vis.bottom() * dpr);
+    if (r <= l || d <= u) return t;
+
+    const QPointF dev0 = QPointF(l / dpr, u / dpr) - origin;
+    t.logical = QRectF((dev0.x() - tl.x()) / s, (dev0.y() - tl.y()) / s,
+                       (r - l) / dpr / s, (d - u) / dpr / s);
+    const double kx = (double)imgSize_.width()  / lastImgSize_.width();
+    const double ky = (double)imgSize_.height() / lastImgSize_.height();
+    t.src = QRectF((t.logical.x() + cropLeft_) * kx, t.logical.y() * ky,
+                   t.logical.width() * kx, t.logical.height() * ky);
+
+    // 已接近 1:1（预览分支按窗口缩放过）时不必再缩放
+    if (std::fabs((r - l) / t.src.width() - 1.0) > 0.02 || std::fabs((d - u) / t.src.height() - 1.0) > 0.02)
+        t.dst = QSize(int(r - l), int(d - u));
+    return t;
+}
+
+const VideoSurfaceItem::PrescaleTarget& VideoSurfaceItem::currentPrescaleTarget()
+{
+    const PrescaleTarget t = computePrescaleTarget();
+    if (!(t == prescaleTarget_)) {
+        prescaleTarget_ = t;
+        ++prescaleGen_;                      // 在途的旧结果到达时丢弃
+        scaled_ = QImage();
+    }
+    return prescaleTarget_;
+}
+
+void VideoSurfaceItem::onScaled(const QImage& img, quint64 gen)
+{
+    if (!prescaler_ || gen != prescaleGen_) return;
+    scaled_ = img;
+    scaledDirty_ = true;
+    update();
+}
+
+void VideoSurfaceItem::setOverlayStrip(const QImage& strip)
+{
+    if (strip.isNull()) {
+        if (overlaySize_.isEmpty()) return;
+        overlayPending_ = QImage();
+        overlaySize_ = QSize();
+        overlayKey_ = 0;
+        overlayDirty_ = true;
+        update();
+        return;
+    }
+    if (strip.cacheKey() == overlayKey_) return;
+    overlayPending_ = strip;
+    overlaySize_ = strip.size();
+    overlayKey_ = strip.cacheKey();
+    overlayDirty_ = true;
+    update();
+}
+
+int VideoSurfaceItem::fitPixelWidth() const
+{
+    if (!hasImage()) return 0;
+    const double sFit = fitScale();
+    if (sFit <= 0.0) return 0;
+    const double dpr = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    return (int)std::ceil(lastImgSize_.width() * sFit * dpr);
+}
+
+void VideoSurfaceItem::resetView()
+{
+    const bool changed = !qFuzzyCompare(zoom_, 1.0);
+    zoom_ = 1.0;            // 1.0 = fit-to-item
+    pan_  = QPointF(0, 0);  // 在 fit 后坐标系里平移
+    clampPan();
+    update();
+    if (changed) emit zoomChanged();
+}
+
+QSizeF VideoSurfaceItem::croppedSize() const
+{
+    return QSizeF(lastImgSize_.width() - cropLeft_ - cropRight_, lastImgSize_.height());
+}
+
+double VideoSurfaceItem::fitScale() const
+{
+    const QSizeF iw = croppedSize();
+    if (iw.width() <= 0 || iw.height() <= 0) return 0.0;
+    return qMin(width() / iw.width(), height() / iw.height());
+}
+
+QPointF VideoSurfaceItem::drawTopLeft(double scale) const
+{
+    const QSizeF iw = croppedSize();
+    return QPointF((width()  - iw.width()  * scale) * 0.5,
+                   (height() - iw.height() * scale) * 0.5) + pan_;
+}
+
+QSGNode* VideoSurfaceItem::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*)
+{
+    auto* n = static_cast<VideoSurfaceNode*>(oldNode);
+    if (!hasImage()) {
+        delete n;
+        return nullptr;
+    }
+    if (!n) n = new VideoSurfaceNode;
+
+    // 预缩放：当前视图已有缩放结果时贴它，否则贴原始帧由场景图缩放（视图刚变化或结果未到）
+    if (prescaler_) currentPrescaleTarget();
+    const bool useScaled = prescaler_ && !scaled_.isNull();
+    if (useScaled ? (scaledDirty_ || !textureScaled_) : (imageDirty_ || textureScaled_)) {
+        const QImage& up = useScaled ? scaled_ : pending_;
+        if (!up.isNull()) {
+            // software 后端包装成 QPixmap，OpenGL 后端在渲染线程上传
+            QSGTexture* tex = window()->createTextureFromImage(up, QQuickWindow::TextureIsOpaque);
+            (useScaled ? scaledDirty_ : imageDirty_) = false;
+            if (!prescaler_) pending_ = QImage();      // 不预缩放时之后不再持有帧
+            if (!tex) return n;
+            if (!n->image) {
+                n->image = window()->createImageNode();
+                n->xform->prependChildNode(n->image);  // 横幅在其上
+            }
+            n->image->setTexture(tex);
+            delete n->texture;
+            n->texture = tex;
+            n->image->markDirty(QSGNode::DirtyMaterial);
+            textureScaled_ = useScaled;
+        }
+    }
+
+    if (overlayDirty_) {
+        overlayDirty_ = false;
+        QSGTexture* tex = overlayPending_.isNull()
+            ? nullptr : window()->createTextureFromImage(overlayPending_, QQuickWindow::TextureIsOpaque);
+        overlayPending_ = QImage();
+        if (!tex && n->overlay) {
+            n->xform->removeChildNode(n->overlay);
+            delete n->overlay;
+            n->overlay = nullptr;
+        } else if (tex && !n->overlay) {
+            n->overlay = window()->createImageNode();
+            n->xform->appendChildNode(n->overlay);
+        }
+        if (n->overlay) {
+            n->overlay->setTexture(tex);
+            n->overlay->markDirty(QSGNode::DirtyMaterial);
+        }
+        delete n->overlayTexture;
+        n->overlayTexture = tex;
+    }
+
+    if (n->image && !imgSize_.isEmpty()) {
+        const QSizeF iw = croppedSize();
+        const double s = fitScale() * zoom_;
+        const QPointF tl = drawTopLeft(s);
+
+        // 图像节点工作在逻辑坐标（裁剪后原点为 0），缩放与平移全在变换节点上
+        QMatrix4x4 m;
+        m.translate(tl.x(), tl.y());
+        m.scale(s, s);
+        n->xform->setMatrix(m);
+
+        // 逻辑坐标 -> 纹理像素（预览帧已缩放时）
+        const double kx = (double)imgSize_.width()  / lastImgSize_.width();
+        const double ky = (double)imgSize_.height() / lastImgSize_.height();
+        const QRectF src(cropLeft_ * kx, 0, iw.width() * kx, lastImgSize_.height() * ky);
+
+        // 预览帧已按窗口缩放时接近 1:1，不必线性插值
+        const double dpr = window()->effectiveDevicePixelRatio();
+        const double devScale = src.width() > 0 ? iw.width() * s * dpr / src.width() : 1.0;
+        const QSGTexture::Filtering filtering =
+            std::fabs(devScale - 1.0) > 0.02 ? QSGTexture::Linear : QSGTexture::Nearest;
+        if (textureScaled_) {
+            // 缩放结果只覆盖可见区域，逐像素贴
+            n->image->setRect(prescaleTarget_.logical);
+            n->image->setSourceRect(QRectF(QPointF(0, 0), QSizeF(prescaleTarget_.dst)));
+            n->image->setFiltering(QSGTexture::Nearest);
+        } else {
+            n->image->setRect(QRectF(QPointF(0, 0), iw));
+            n->image->setSourceRect(src);
+            n->image->setFiltering(filtering);
+        }
+
+        if (n->overlay) {
+            // 横幅按帧像素定位（帧内水平居中、距顶 6px），换算到逻辑坐标后与帧一起裁剪
+            const double ow = overlaySize_.width() / kx, oh = overlaySize_.height() / ky;
+            const QRectF full((lastImgSize_.width() - ow) * 0.5 - cropLeft_, 6.0 / ky, ow, oh);
+            const QRectF vis = full.intersected(QRectF(QPointF(0, 0), iw));
+            n->overlay->setRect(vis);
+            n->overlay->setSourceRect(QRectF((vis.x() - full.x()) * kx, (vis.y() - full.y()) * ky,
+                                             vis.width() * kx, vis.height() * ky));
+            n->overlay->setFiltering(filtering);
+        }
+    }
+
+    // 十字准线 — 仅在屏幕绘制，不影响录像/截图数据
+    if (crosshairEnabled_ && !n->arms[0]) {
+        for (QSGRectangleNode*& a : n->arms) {
+            a = window()->createRectangleNode();
+            a->setColor(QColor(0, 255, 153, 210));
+            n->cross->appendChildNode(a);
+        }
+    } else if (!crosshairEnabled_ && n->arms[0]) {
+        for (QSGRectangleNode*& a : n->arms) {
+            n->cross->removeChildNode(a);
+            delete a;
+            a = nullptr;
+        }
+    }
+    if (n->arms[0]) {
+        const QPointF c(width() * 0.5, height() * 0.5);
+        const double arm = 18.0, t = 1.5, dot = 4.0;
+        n->arms[0]->setRect(QRectF(c.x() - arm, c.y() - t * 0.5, arm * 2, t));
+        n->arms[1]->setRect(QRectF(c.x() - t * 0.5, c.y() - arm, t, arm * 2));
+        n->arms[2]->setRect(QRectF(c.x() - dot * 0.5, c.y() - dot * 0.5, dot, dot));
+    }
+    return n;
+}
+
+void VideoSurfaceItem::onGeometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    if (newGeometry.size() == oldGeometry.size()) return;
+    clampPan();
+    update();
+    emit viewResized();
+}
+
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+void VideoSurfaceItem::geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChange(newGeometry, oldGeometry);
+    onGeometryChanged(newGeometry, oldGeometry);
+}
+#else
+void VideoSurfaceItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    onGeometryChanged(newGeometry, oldGeometry);
+}
+#endif
+
+void VideoSurfaceItem::wheelEvent(QWheelEvent* e)
+{
+    if (!hasImage()) { e->ignore(); return; }
+
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    const QPointF pos = e->position();
+#else
+    const QPointF pos = e->posF();
+#endif
+    const int delta = e->angleDelta().y();
+    if (delta == 0) { e->ignore(); return; }
+
+    zoomAt(pos, (delta > 0) ? 1.15 : (1.0 / 1.15));
+    e->accept();
+}
+
+void VideoSurfaceItem::mousePressEvent(QMouseEvent* e)
+{
+    if (e->button() != Qt::LeftButton) { e->ignore(); return; }
+    if (zoom_ > 1.0 + 1e-6) {
+        dragging_ = true;
+        lastMousePos_ = e->localPos();
+        setCursor(Qt::ClosedHandCursor);
+    }
+    e->accept();
+}
+
+void VideoSurfaceItem::mouseMoveEvent(QMouseEvent* e)
+{
+    if (!dragging_) { e->ignore(); return; }
+    const QPointF cur = e->localPos();
+    pan_ += cur - lastMousePos_;
+    lastMousePos_ = cur;
+    clampPan();
+    update();
+    e->accept();
+}
+
+void VideoSurfaceItem::mouseReleaseEvent(QMouseEvent* e)
+{
+    if (e->button() == Qt::LeftButton && dragging_) {
+        dragging_ = false;
+        unsetCursor();
+    }
+    e->accept();
+}
+
+void VideoSurfaceItem::mouseDoubleClickEvent(QMouseEvent* e)
+{
+    if (e->button() != Qt::LeftButton) { e->ignore(); return; }
+    emit doubleClicked();
+    e->accept();
+}
+
+void VideoSurfaceItem::clampZoom()
+{
+    zoom_ = qBound(minZoom_, zoom_, maxZoom_);
+}
+
+void VideoSurfaceItem::clampPan()
+{
+    if (!hasImage()) return;
+    const QSizeF iw = croppedSize();
+    const double s = fitScale() * zoom_;
+    const QSizeF drawSize(iw.width() * s, iw.height() * s);
+
+    auto clampAxis = [](double viewLen, double imgLen, double panVal) -> double {
+        if (imgLen <= viewLen) return 0.0;             // 图像比视频区小：强制居中
+        const double over = imgLen - viewLen;
+        return qBound(-over * 0.5, panVal, over * 0.5);
+    };
+    pan_.setX(clampAxis(width(),  drawSize.width(),  pan_.x()));
+    pan_.setY(clampAxis(height(), drawSize.height(), pan_.y()));
+}
+
+void VideoSurfaceItem::zoomAt(const QPointF& pos, double factor)
+{
+    const double oldZoom = zoom_;
+    const double newZoom = qBound(minZoom_, zoom_ * factor, maxZoom_);
+    if (qFuzzyCompare(newZoom, oldZoom)) return;
+
+    const QSizeF iw = croppedSize();
+    const double sFit = fitScale();
+    const QSizeF drawOld(iw.width() * sFit * oldZoom, iw.height() * sFit * oldZoom);
+    const QSizeF drawNew(iw.width() * sFit * newZoom, iw.height() * sFit * newZoom);
+
+    // 鼠标在旧绘制图像上的归一化位置 (0~1)
+    const QPointF localOld = pos - drawTopLeft(sFit * oldZoom);
+    const double u = (drawOld.width()  > 1e-9) ? (localOld.x() / drawOld.width())  : 0.5;
+    const double v = (drawOld.height() > 1e-9) ? (localOld.y() / drawOld.height()) : 0.5;
+
+    zoom_ = newZoom;
+
+    // 反推 pan_，保证 pos 指向的图像点不变
+    const QPointF baseNew((width() - drawNew.width()) * 0.5, (height() - drawNew.height()) * 0.5);
+    pan_ = pos - baseNew - QPointF(u * drawNew.width(), v * drawNew.height());
+
+    clampPan();
+    update();
+    emit zoomChanged();
+}
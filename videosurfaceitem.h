@@ -0,0 +1,121 @@
+// videosurfaceitem.h
+// HUD 场景图里的视频面（QML 类型 VideoSurface，放在 Main.qml 的 videoArea 中）。
+// 每帧作为纹理节点上传；缩放/平移/显示裁剪是变换节点 + 源矩形，十字准线是矩形节点。
+// 叠加横幅是帧之上的独立纹理层（只在内容变化时上传），不烧进帧拷贝。
+// 可选预缩放（setPrescaleEnabled）：FrameScaler 线程把可见区域缩放到设备像素尺寸，场景图只 1:1 贴图。
+// 只用 QSGImageNode / QSGRectangleNode，OpenGL 与 software 场景图后端都能用；
+// 视频与 HUD 在同一遍合成，不再把 QWidget 叠在 QQuickWidget 上。
+#pragma once
+
+#include <QImage>
+#include <QPointF>
+#include <QQuickItem>
+#include <QRectF>
+#include <QSize>
+
+class FrameScaler;
+class QThread;
+
+class VideoSurfaceItem : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(double zoom READ zoom NOTIFY zoomChanged)
+    Q_PROPERTY(bool crosshairEnabled READ crosshairEnabled WRITE setCrosshairEnabled NOTIFY crosshairEnabledChanged)
+public:
+    explicit VideoSurfaceItem(QQuickItem* parent = nullptr);
+    ~VideoSurfaceItem() override;
+
+    void setZoomRange(double minZ, double maxZ);
+    double zoom() const { return zoom_; }
+
+    // 显示裁剪（仅影响显示，不影响录像）；单位是逻辑（源）像素
+    void setDisplayCrop(int left, int right);
+    bool crosshairEnabled() const { return crosshairEnabled_; }
+    void setCrosshairEnabled(bool en);
+
+    // logicalSize：图像对应的源尺寸（预览帧可能是缩放后的）。缩放/平移/裁剪都按逻辑尺寸计算，
+    // 预览帧与全分辨率帧之间切换时画面不跳动。无效时等于图像尺寸。
+    void setImage(const QImage& img, const QSize& logicalSize = QSize());
+
+    // 显示用叠加横幅（与当前帧同一像素比例，帧内顶部居中、距顶 6px，随缩放/平移/裁剪一起变换）。
+    // 同一横幅（QImage::cacheKey 不变）重复设置不会重新上传；空图 = 不叠加
+    void setOverlayStrip(const QImage& strip);
+
+    // 预缩放：每帧在工作线程缩放到当前缩放/平移/裁剪下的目标尺寸，渲染时不再缩放。
+    // 视图变化后旧结果作废，新结果到达前临时由场景图缩放原始帧。适合 software 后端（缩放在 GUI 线程）
+    void setPrescaleEnabled(bool on);
+
+    // 放大倍率为 1（适应窗口）时需要的源图宽度（设备像素）：预览分支按此缩放即可 1:1 显示
+    int fitPixelWidth() const;
+    void resetView();
+
+signals:
+    void zoomChanged();
+    void crosshairEnabledChanged();
+    void viewResized();
+    void doubleClicked();
+
+protected:
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData*) override;
+#if QT_VERSION >= QT_VERSION_CHECK(6,0,0)
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+#else
+    void geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+#endif
+    void wheelEvent(QWheelEvent* e) override;
+    void mousePressEvent(QMouseEvent* e) override;
+    void mouseMoveEvent(QMouseEvent* e) override;
+    void mouseReleaseEvent(QMouseEvent* e) override;
+    void mouseDoubleClickEvent(QMouseEvent* e) override;
+
+private:
+    bool    hasImage() const { return !lastImgSize_.isEmpty(); }
+    QSizeF  croppedSize() const;             // 裁剪后的逻辑尺寸
+    double  fitScale() const;
+    QPointF drawTopLeft(double scale) const; // 当前缩放/平移下图像左上角（item 坐标）
+    void    clampZoom();
+    void    clampPan();
+    void    zoomAt(const QPointF& pos, double factor);
+    void    onGeometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry);
+
+    struct PrescaleTarget {
+        QRectF logical;                      // 可见区域（逻辑坐标，裁剪后原点为 0），边缘对齐设备像素
+        QRectF src;                          // 对应的原始帧像素区域
+        QSize  dst;                          // 目标设备像素尺寸；空 = 已接近 1:1，不需要预缩放
+        bool operator==(const PrescaleTarget& o) const
+        { return dst == o.dst && logical == o.logical && src == o.src; }
+    };
+    PrescaleTarget computePrescaleTarget() const;
+    const PrescaleTarget& currentPrescaleTarget();   // 视图变化时换代并丢弃过期的缩放结果
+    void    onScaled(const QImage& img, quint64 gen);
+
+    QImage  pending_;                        // 待上传的帧（上传后释放；预缩放时保留作回退）
+    bool    imageDirty_ = false;
+    QSize   imgSize_;                        // 当前纹理的像素尺寸
+    QSize   lastImgSize_;                    // 逻辑尺寸
+
+    QImage  overlayPending_;                 // 待上传的横幅
+    bool    overlayDirty_ = false;
+    QSize   overlaySize_;                    // 当前横幅纹理的像素尺寸
+    qint64  overlayKey_ = 0;                 // 当前横幅的 QImage::cacheKey
+
+    FrameScaler*   prescaler_ = nullptr;     // 在 prescaleThread_ 上
+    QThread*       prescaleThread_ = nullptr;
+    PrescaleTarget prescaleTarget_;
+    quint64        prescaleGen_ = 0;
+    QImage         scaled_;                  // 当前代的缩放结果
+    bool           scaledDirty_ = false;
+    bool           textureScaled_ = false;   // 图像节点当前贴的是缩放结果
+
+    double  minZoom_ = 1.0;
+    double  maxZoom_ = 3.0;
+    double  zoom_    = 1.0;
+    QPointF pan_;
+
+    bool    dragging_ = false;
+    QPointF lastMousePos_;
+
+    int     cropLeft_  = 0;
+    int     cropRight_ = 0;
+    bool    crosshairEnabled_ = false;
+};